@@ -35,9 +35,32 @@ FractalWidget::FractalWidget(QWidget * parent)
 	param3Edit->setMaximum(1000);
 	param3Edit->setValue(0);
 
+	paletteLabel_ = new QLabel("Palette: ", this);
+	paletteEdit = new QComboBox(this);
+	paletteEdit->addItems({"Grey", "Fire", "Ocean"});
+
+	contrastLabel_ = new QLabel("Contrast: ", this);
+	contrastEdit = new QSlider(this);
+	contrastEdit->setOrientation(Qt::Horizontal);
+	contrastEdit->setMinimum(10);
+	contrastEdit->setMaximum(400);
+	contrastEdit->setValue(100);
+
+	cycleLabel_ = new QLabel("Colour cycle: ", this);
+	cycleEdit = new QSlider(this);
+	cycleEdit->setOrientation(Qt::Horizontal);
+	cycleEdit->setMinimum(0);
+	cycleEdit->setMaximum(99);
+	cycleEdit->setValue(0);
+
 	fpsLabel_ = new QLabel("FPS: ", this);
 	fpsLabelValue_ = new QLabel(QString::number(0.0), this);
 
+	frameStatsLabel_ = new QLabel("Frame times: ", this);
+	frameStatsLabelValue_ = new QLabel(this);
+	frameStatsLabel_->hide();
+	frameStatsLabelValue_->hide();
+
 	grid->addWidget(iterationsLabel_, 0, 0);
 	grid->addWidget(iterationsEdit, 0, 1);
 
@@ -50,7 +73,19 @@ FractalWidget::FractalWidget(QWidget * parent)
 	grid->addWidget(param3Label, 4, 0);
 	grid->addWidget(param3Edit, 4, 1);
 
-	grid->addWidget(fpsLabel_, 5, 0);
-	grid->addWidget(fpsLabelValue_, 5, 1);
+	grid->addWidget(paletteLabel_, 5, 0);
+	grid->addWidget(paletteEdit, 5, 1);
+
+	grid->addWidget(contrastLabel_, 6, 0);
+	grid->addWidget(contrastEdit, 6, 1);
+
+	grid->addWidget(cycleLabel_, 7, 0);
+	grid->addWidget(cycleEdit, 7, 1);
+
+	grid->addWidget(fpsLabel_, 8, 0);
+	grid->addWidget(fpsLabelValue_, 8, 1);
+
+	grid->addWidget(frameStatsLabel_, 9, 0);
+	grid->addWidget(frameStatsLabelValue_, 9, 1);
 	setLayout(grid);
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QComboBox>
 #include <QLabel>
 #include <QLineEdit>
 #include <QSlider>
@@ -10,13 +11,24 @@ public:
 	FractalWidget(QWidget * parent = nullptr);
 	QLabel * fpsLabel_;
 	QLabel * fpsLabelValue_;
+	// Hidden unless frame statistics were requested.
+	QLabel * frameStatsLabel_;
+	QLabel * frameStatsLabelValue_;
 	QLabel * param1Label;
 	QLabel * param2Label;
 	QLabel * param3Label;
 	QLabel * iterationsLabel_;
-	
+	QLabel * paletteLabel_;
+	QLabel * contrastLabel_;
+	QLabel * cycleLabel_;
+
 	QSlider * param1Edit;
 	QSlider * param2Edit;
 	QSlider * param3Edit;
 	QSlider * iterationsEdit;
+	QComboBox * paletteEdit;
+	// Contrast in percent, 100 is linear.
+	QSlider * contrastEdit;
+	// Palette phase in percent.
+	QSlider * cycleEdit;
 };
@@ -1,13 +1,23 @@
 #include "FractalWindow.h"
 
+#include <Core/JuliaRenderer.hpp>
+#include <Core/Palette.hpp>
+#include <Core/PanReuse.hpp>
+#include <Core/Symmetry.hpp>
+#include <Core/Trace.hpp>
+
 #include <QLabel>
 #include <QMouseEvent>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
 #include <QScreen>
 #include <QVBoxLayout>
 
+#include <algorithm>
 #include <array>
+#include <cfloat>
+#include <cmath>
 #include <string>
 
 namespace {
@@ -24,20 +34,137 @@ constexpr std::array<GLfloat, 8u> vertices = {
 };
 constexpr std::array<GLuint, 6u> indices = {0, 1, 2, 1, 2, 3};
 
+constexpr auto g_fps_interval_ms = 1000;
+// A reprojected frame becomes exact after this many frames.
+constexpr auto g_refine_passes = 8;
+// Quiet time after the last change before the view renders at native
+// resolution again.
+constexpr auto g_idle_ms = 200;
+
+// Forced shader precisions, the policy has nothing to pick from.
+constexpr std::array<fgl::PrecisionTier, 1> g_float_shader = {fgl::PrecisionTier::FloatShader};
+constexpr std::array<fgl::PrecisionTier, 1> g_df64_shader = {fgl::PrecisionTier::Df64Shader};
+// Pixel deltas of deeper views underflow a double, see Core/DeepZoom.hpp.
+constexpr auto g_max_zoom = 1e280;
+// Texels per row of the reference orbit texture.
+constexpr auto g_orbit_width = 1024;
+// Neighbouring pixels have to be further apart than this fraction of |Z|
+// before a pixel leaves the reference, float deltas need a coarser switch
+// than the double ones of the CPU renderer.
+constexpr auto g_float_direct_spread = 1e-3;
+
+// hi + lo of two floats, for the df64 shader.
+QVector2D splitDouble(const double value) {
+	const auto hi = static_cast<float>(value);
+	return QVector2D(hi, static_cast<float>(value - static_cast<double>(hi)));
+}
+
 }// namespace
 
-void FractalWindow::init() {
+FractalWindow::FractalWindow(QWindow * parent)
+	: fgl::GLWindow{parent}
+{
+	updatePrecisionTier();
+	published_ = snapshot();
+	snapshots_.publish(published_);
+
+	// Label updates have to happen on the GUI thread.
 	m_time.start();
+	fpsTimer_.setInterval(g_fps_interval_ms);
+	QObject::connect(&fpsTimer_, &QTimer::timeout, this, &FractalWindow::updateFpsCounter);
+	fpsTimer_.start();
+
+	idleTimer_.setInterval(g_idle_ms);
+	idleTimer_.setSingleShot(true);
+	QObject::connect(&idleTimer_, &QTimer::timeout, this, &FractalWindow::settle);
 
-	// Configure shaders
-	program_ = std::make_unique<QOpenGLShaderProgram>(this);
+	QObject::connect(this, &QWindow::widthChanged, this, &FractalWindow::sizeChanged);
+	QObject::connect(this, &QWindow::heightChanged, this, &FractalWindow::sizeChanged);
+}
+
+FractalWindow::~FractalWindow() {
+	shutdown();
+}
+
+void FractalWindow::init() {
+	// Every field shader places its samples with the same uniforms
+	const auto gridUniforms = [](QOpenGLShaderProgram & program) {
+		GridUniforms uniforms;
+		uniforms.viewSize = program.uniformLocation("view_size");
+		uniforms.stride = program.uniformLocation("stride");
+		uniforms.reuse = program.uniformLocation("reuse");
+		uniforms.previousField = program.uniformLocation("previous_field");
+		return uniforms;
+	};
+
+	// Configure shaders, no QObject parents since this may run on the render thread
+	program_ = std::make_unique<QOpenGLShaderProgram>();
 	program_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/diffuse.vs");
 	program_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/diffuse.fs");
 	program_->link();
 
+	blitProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	blitProgram_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/blit.vs");
+	blitProgram_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/blit.fs");
+	blitProgram_->link();
+	imageUniform_ = blitProgram_->uniformLocation("image");
+	topDownUniform_ = blitProgram_->uniformLocation("top_down");
+
+	colouriseProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	colouriseProgram_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/blit.vs");
+	colouriseProgram_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/colourise.fs");
+	colouriseProgram_->link();
+	fieldUniform_ = colouriseProgram_->uniformLocation("field");
+	fieldTopDownUniform_ = colouriseProgram_->uniformLocation("top_down");
+	fieldIterationsUniform_ = colouriseProgram_->uniformLocation("iterations");
+	paletteUniform_ = colouriseProgram_->uniformLocation("palette");
+	contrastUniform_ = colouriseProgram_->uniformLocation("contrast");
+	cycleUniform_ = colouriseProgram_->uniformLocation("cycle");
+	fieldExtentUniform_ = colouriseProgram_->uniformLocation("field_extent");
+
+	reprojectProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	reprojectProgram_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/reproject.vs");
+	reprojectProgram_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/reproject.fs");
+	reprojectProgram_->link();
+	previousUniform_ = reprojectProgram_->uniformLocation("previous");
+	scaleUniform_ = reprojectProgram_->uniformLocation("scale");
+	offsetUniform_ = reprojectProgram_->uniformLocation("offset");
+
+	df64Program_ = std::make_unique<QOpenGLShaderProgram>();
+	df64Program_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/diffuse.vs");
+	df64Program_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/diffuse_df64.fs");
+	df64Program_->link();
+	df64CentreXUniform_ = df64Program_->uniformLocation("centre_x");
+	df64CentreYUniform_ = df64Program_->uniformLocation("centre_y");
+	df64InvZoomUniform_ = df64Program_->uniformLocation("inv_zoom");
+	df64IterationsUniform_ = df64Program_->uniformLocation("iterations");
+	df64ConstantUniform_ = df64Program_->uniformLocation("constant");
+	df64PeriodEpsilonUniform_ = df64Program_->uniformLocation("period_epsilon");
+	df64GridUniforms_ = gridUniforms(*df64Program_);
+
+	perturbProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	perturbProgram_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/diffuse.vs");
+	perturbProgram_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/perturb.fs");
+	perturbProgram_->link();
+	perturbIterationsUniform_ = perturbProgram_->uniformLocation("iterations");
+	constantUniform_ = perturbProgram_->uniformLocation("constant");
+	orbitUniform_ = perturbProgram_->uniformLocation("orbit");
+	orbitWidthUniform_ = perturbProgram_->uniformLocation("orbit_width");
+	orbitLastUniform_ = perturbProgram_->uniformLocation("orbit_last");
+	pixelMantissaUniform_ = perturbProgram_->uniformLocation("pixel_mantissa");
+	pixelExponentUniform_ = perturbProgram_->uniformLocation("pixel_exponent");
+	seriesSkipUniform_ = perturbProgram_->uniformLocation("series_skip");
+	seriesScaleUniform_ = perturbProgram_->uniformLocation("series_scale");
+	seriesAUniform_ = perturbProgram_->uniformLocation("series_a");
+	seriesBUniform_ = perturbProgram_->uniformLocation("series_b");
+	seriesCUniform_ = perturbProgram_->uniformLocation("series_c");
+	seriesExponentUniform_ = perturbProgram_->uniformLocation("series_exponent");
+	perturbGridUniforms_ = gridUniforms(*perturbProgram_);
+
 	// Create VAO object
-	vao_.create();
-	vao_.bind();
+	vao_ = std::make_unique<QOpenGLVertexArrayObject>();
+	vao_->create();
+	vao_->bind();
 
 	// Create VBO
 	vbo_.create();
@@ -63,11 +190,13 @@ void FractalWindow::init() {
 	param3Uniform_ = program_->uniformLocation("param3");
 	zoomUniform_ = program_->uniformLocation("zoom");
 	shiftUniform_ = program_->uniformLocation("shift");
+	periodEpsilonUniform_ = program_->uniformLocation("period_epsilon");
+	gridUniforms_ = gridUniforms(*program_);
 
 	// Release all
 	program_->release();
 
-	vao_.release();
+	vao_->release();
 
 	ibo_.release();
 	vbo_.release();
@@ -81,102 +210,963 @@ void FractalWindow::init() {
 }
 
 void FractalWindow::render() {
+	// Pick up the newest parameters, the size comes from the window
+	snapshots_.update();
+	const auto & snapshot = snapshots_.latest();
+	auto view = snapshot.view;
+	const auto colour = snapshot.colour;
+	// The field of interactive frames may be smaller than the framebuffer,
+	// which already has devicePixelRatio() applied
+	outputSize_ = framebufferSize();
+	const auto interactive = snapshot.interactive && frameBudget_ > 0.0;
+	// Frames that only change colours keep the field, another size would
+	// compute it again
+	const auto sameField = hasPrevious_ && snapshot.view == previousSnapshotView_ && snapshot.tier == previousTier_
+		&& snapshot.centreX == previousCentreX_ && snapshot.centreY == previousCentreY_;
+	const auto scale = !interactive ? 1.0f : sameField ? renderScale_.load() : governor_.scale();
+	view.width = std::max(1, static_cast<int>(std::lround(static_cast<float>(outputSize_.width()) * scale)));
+	view.height = std::max(1, static_cast<int>(std::lround(static_cast<float>(outputSize_.height()) * scale)));
+	renderScale_ = scale;
+
+	// Deep tiers start from the exact centre, perturbation iterates deltas
+	// against its reference orbit and double-double splits it into two doubles
+	fgl::DeepViewport deep;
+	deep.view = view;
+	deep.view.shiftX = 0.0;
+	deep.view.shiftY = 0.0;
+	deep.centreX = snapshot.centreX;
+	deep.centreY = snapshot.centreY;
+	const auto tier = snapshot.tier;
+	const auto deepTier = fgl::isPerturbation(tier) || tier == fgl::PrecisionTier::CpuDoubleDouble;
+	df64Field_ = tier == fgl::PrecisionTier::Df64Shader;
+	if (tier != previousTier_ || view.width != previousView_.width || view.height != previousView_.height) {
+		hasPrevious_ = false;
+	}
+
 	// Configure viewport
-	const auto retinaScale = devicePixelRatio();
-	glViewport(0, 0, static_cast<GLint>(width() * retinaScale),
-			   		static_cast<GLint>(height() * retinaScale));
+	glViewport(0, 0, outputSize_.width(), outputSize_.height());
 
 	// Clear buffers
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	{
+		const GpuScope scope{*this, "clear"};
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	const auto * deepView = deepTier ? &deep : nullptr;
+	if (snapshot.backend == Backend::Cpu) {
+		renderCpu(view, deepView, tier, colour);
+	} else {
+		renderGpu(view, deepView, tier, colour);
+	}
+	previousView_ = view;
+	previousSnapshotView_ = snapshot.view;
+	previousTier_ = tier;
+	previousDeep_ = deepTier;
+	previousCentreX_ = deep.centreX;
+	previousCentreY_ = deep.centreY;
+	hasPrevious_ = true;
+	updateRenderScale(tier, interactive);
+
+	// Increment frame counter
+	++frame_;
+}
+
+void FractalWindow::updateFpsCounter() {
+	const auto elapsedSeconds = static_cast<float>(m_time.restart()) / 1000.0f;
+	const auto frames = frame_.exchange(0);
+	const auto fps = static_cast<size_t>(std::round(static_cast<float>(frames) / elapsedSeconds));
+	if (fpsLabelValue_ != nullptr) {
+		// In on-demand mode no frames means nothing changed
+		fpsLabelValue_->setText(frames == 0 ? QString("idle") : QString::number(fps));
+	}
+	if (frameStatsLabelValue_ != nullptr) {
+		// Tails matter more than the average
+		const auto cpu = frameStats().summary(fgl::FrameMetric::Cpu);
+		const auto swap = frameStats().summary(fgl::FrameMetric::Swap);
+		auto text = QString("cpu p50 %1 p95 %2 p99 %3 max %4 ms, swap p99 %5 ms")
+						.arg(cpu.p50, 0, 'f', 2)
+						.arg(cpu.p95, 0, 'f', 2)
+						.arg(cpu.p99, 0, 'f', 2)
+						.arg(cpu.max, 0, 'f', 2)
+						.arg(swap.p99, 0, 'f', 2);
+		// GPU time per pass tells shader cost apart from submission and resolve
+		const auto & stats = frameStats();
+		for (size_t pass = 0; pass < stats.gpuPassCount(); ++pass) {
+			const auto gpu = stats.gpuSeries(pass).summary();
+			text += QString(", %1 p95 %2 ms").arg(QString::fromStdString(stats.gpuPassName(pass))).arg(gpu.p95, 0, 'f', 2);
+		}
+		// Which tier the policy picked and what its field pass costs
+		const auto tier = precisionPolicy_.tier();
+		text += QString(", tier %1").arg(fgl::tierName(tier));
+		const auto * cost = tierCost(tier);
+		if (cost != nullptr) {
+			text += QString(" p50 %1 ms").arg(cost->summary().p50, 0, 'f', 2);
+		}
+		const auto scale = renderScale_.load();
+		if (scale < 1.0f) {
+			text += QString(", scale %1").arg(static_cast<double>(scale), 0, 'f', 2);
+		}
+		frameStatsLabelValue_->setText(text);
+	}
+}
+
+void FractalWindow::drawFractal(const fgl::Viewport & view) {
+	if (df64Field_) {
+		drawFractalDf64(view);
+		return;
+	}
 
 	// Bind VAO and shader program
 	program_->bind();
-	vao_.bind();
+	vao_->bind();
 
 	// Update uniform value
-	program_->setUniformValue(iterationsUniform_, iterations_);
-	program_->setUniformValue(param1Uniform_, param1_);
-	program_->setUniformValue(param2Uniform_, param2_);
-	program_->setUniformValue(param3Uniform_, param3_);
-	program_->setUniformValue(zoomUniform_, zoom_);
-	program_->setUniformValue(shiftUniform_, globalShift_ + shift_);
+	program_->setUniformValue(iterationsUniform_, view.iterations);
+	program_->setUniformValue(param1Uniform_, view.param1);
+	program_->setUniformValue(param2Uniform_, view.param2);
+	program_->setUniformValue(param3Uniform_, view.param3);
+	program_->setUniformValue(zoomUniform_, static_cast<float>(view.zoom));
+	program_->setUniformValue(shiftUniform_, QVector2D(static_cast<float>(view.shiftX), static_cast<float>(view.shiftY)));
+	program_->setUniformValue(periodEpsilonUniform_, static_cast<float>(periodicityTolerance_ * view.pixelSpacingX()));
+	setGridUniforms(*program_, gridUniforms_, view);
 
 	// Draw
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 
 	// Release VAO and shader program
-	vao_.release();
+	vao_->release();
 	program_->release();
+}
 
-	// Increment frame counter
-	if (m_time.elapsed() >= 1000) {
-		const auto elapsedSeconds = static_cast<float>(m_time.restart()) / 1000.0f;
-		fps = static_cast<size_t>(std::round(frame_ / elapsedSeconds));
-		std::string str = std::to_string(fps);
-		if (fpsLabelValue_ != nullptr) {
-			fpsLabelValue_->setText(QString::fromUtf8(str.c_str()));
+void FractalWindow::drawFractalDf64(const fgl::Viewport & view) {
+	df64Program_->bind();
+	vao_->bind();
+
+	// The centre and 1 / zoom keep 48 bits as hi, lo pairs
+	df64Program_->setUniformValue(df64CentreXUniform_, splitDouble(view.shiftX / view.zoom));
+	df64Program_->setUniformValue(df64CentreYUniform_, splitDouble(view.shiftY / view.zoom));
+	df64Program_->setUniformValue(df64InvZoomUniform_, splitDouble(1.0 / view.zoom));
+	df64Program_->setUniformValue(df64IterationsUniform_, view.iterations);
+	df64Program_->setUniformValue(df64ConstantUniform_, QVector2D(view.constantRe(), view.constantIm()));
+	df64Program_->setUniformValue(df64PeriodEpsilonUniform_, static_cast<float>(periodicityTolerance_ * view.pixelSpacingX()));
+	setGridUniforms(*df64Program_, df64GridUniforms_, view);
+
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+
+	vao_->release();
+	df64Program_->release();
+}
+
+void FractalWindow::updateReference(const fgl::DeepViewport & deep) {
+	fgl::DeepOptions options;
+	options.directSpread = g_float_direct_spread;
+	reference_ = fgl::referenceOrbit(deep, {0.0, 0.0}, options);
+
+	// xy is Z, z the squared delta length that leaves the reference
+	const auto points = static_cast<int>(reference_.points.size());
+	const auto rows = (points + g_orbit_width - 1) / g_orbit_width;
+	orbitTexels_.assign(static_cast<size_t>(g_orbit_width) * static_cast<size_t>(rows) * 4, 0.0f);
+	for (size_t i = 0; i < reference_.points.size(); ++i) {
+		const auto & point = reference_.points[i];
+		orbitTexels_[4 * i] = static_cast<float>(point.z.x);
+		orbitTexels_[4 * i + 1] = static_cast<float>(point.z.y);
+		orbitTexels_[4 * i + 2] = static_cast<float>(std::min(point.directSquared, static_cast<double>(FLT_MAX)));
+	}
+
+	// Runs inside the fractal pass, timer queries cannot nest
+	if (!orbitTexture_ || orbitTexture_->height() != rows) {
+		orbitTexture_ = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+		orbitTexture_->setFormat(QOpenGLTexture::RGBA32F);
+		orbitTexture_->setSize(g_orbit_width, rows);
+		orbitTexture_->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+		orbitTexture_->allocateStorage();
+	}
+	orbitTexture_->setData(QOpenGLTexture::RGBA, QOpenGLTexture::Float32, orbitTexels_.data());
+}
+
+void FractalWindow::drawPerturbation(const fgl::Viewport & view) {
+	perturbProgram_->bind();
+	vao_->bind();
+	glActiveTexture(GL_TEXTURE0);
+	orbitTexture_->bind();
+
+	perturbProgram_->setUniformValue(perturbIterationsUniform_, view.iterations);
+	perturbProgram_->setUniformValue(constantUniform_, QVector2D(view.constantRe(), view.constantIm()));
+	perturbProgram_->setUniformValue(orbitUniform_, 0);
+	perturbProgram_->setUniformValue(orbitWidthUniform_, g_orbit_width);
+	perturbProgram_->setUniformValue(orbitLastUniform_, static_cast<GLint>(reference_.points.size()) - 1);
+
+	// Mantissas and exponents, the deltas are far below the float range
+	auto pixelExponent = 0;
+	const auto pixelMantissa = std::frexp(1.0 / view.zoom, &pixelExponent);
+	perturbProgram_->setUniformValue(pixelMantissaUniform_, static_cast<float>(pixelMantissa));
+	perturbProgram_->setUniformValue(pixelExponentUniform_, pixelExponent);
+
+	// hypot, the squared coefficients may underflow
+	const auto magnitude = [](const glm::dvec2 & v) { return std::hypot(v.x, v.y); };
+	auto seriesExponent = 0;
+	std::frexp(std::max({magnitude(reference_.a), magnitude(reference_.b), magnitude(reference_.c)}), &seriesExponent);
+	const auto seriesMantissa = [seriesExponent](const glm::dvec2 & coefficient) {
+		return QVector2D(static_cast<float>(std::ldexp(coefficient.x, -seriesExponent)),
+						 static_cast<float>(std::ldexp(coefficient.y, -seriesExponent)));
+	};
+	perturbProgram_->setUniformValue(seriesSkipUniform_, reference_.skip);
+	perturbProgram_->setUniformValue(seriesScaleUniform_, static_cast<float>(1.0 / (view.zoom * reference_.radius)));
+	perturbProgram_->setUniformValue(seriesAUniform_, seriesMantissa(reference_.a));
+	perturbProgram_->setUniformValue(seriesBUniform_, seriesMantissa(reference_.b));
+	perturbProgram_->setUniformValue(seriesCUniform_, seriesMantissa(reference_.c));
+	perturbProgram_->setUniformValue(seriesExponentUniform_, seriesExponent);
+	setGridUniforms(*perturbProgram_, perturbGridUniforms_, view);
+
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+
+	orbitTexture_->release();
+	vao_->release();
+	perturbProgram_->release();
+}
+
+void FractalWindow::setGridUniforms(QOpenGLShaderProgram & program, const GridUniforms & uniforms, const fgl::Viewport & view) {
+	program.setUniformValue(uniforms.viewSize, QVector2D(static_cast<float>(view.width), static_cast<float>(view.height)));
+	program.setUniformValue(uniforms.stride, fieldStride_);
+	program.setUniformValue(uniforms.reuse, previousField_ != 0);
+	// Unit 0 may hold the reference orbit
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, previousField_);
+	glActiveTexture(GL_TEXTURE0);
+	program.setUniformValue(uniforms.previousField, 1);
+}
+
+void FractalWindow::drawField(const fgl::Viewport & view, const fgl::DeepViewport * deep) {
+	if (deep) {
+		drawPerturbation(view);
+	} else {
+		drawFractal(view);
+	}
+}
+
+void FractalWindow::drawTexture(GLuint texture, bool topDown) {
+	blitProgram_->bind();
+	vao_->bind();
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	// The texture may still carry the mipmap filter of a reprojection
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	blitProgram_->setUniformValue(imageUniform_, 0);
+	blitProgram_->setUniformValue(topDownUniform_, topDown);
+
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	vao_->release();
+	blitProgram_->release();
+}
+
+void FractalWindow::drawColourise(GLuint field, const QVector2D & extent, const fgl::Viewport & view,
+								  const fgl::ColourSettings & colour) {
+	colouriseProgram_->bind();
+	vao_->bind();
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, field);
+	// Counts must not be blended with their neighbours
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	colouriseProgram_->setUniformValue(fieldUniform_, 0);
+	colouriseProgram_->setUniformValue(fieldExtentUniform_, extent);
+	colouriseProgram_->setUniformValue(fieldTopDownUniform_, false);
+	colouriseProgram_->setUniformValue(fieldIterationsUniform_, view.iterations);
+	colouriseProgram_->setUniformValue(paletteUniform_, static_cast<GLint>(colour.palette));
+	colouriseProgram_->setUniformValue(contrastUniform_, colour.contrast);
+	colouriseProgram_->setUniformValue(cycleUniform_, colour.cycle);
+
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	vao_->release();
+	colouriseProgram_->release();
+}
+
+void FractalWindow::drawReprojection(GLuint previous, const fgl::Viewport & previousView, const fgl::Viewport & view) {
+	// Rebuild the mip chain of the previous frame
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, previous);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// Plane position is (pos + shift) / zoom in both frames
+	const auto scale = previousView.zoom / view.zoom;
+	const QVector2D offset{static_cast<float>(view.shiftX * scale - previousView.shiftX),
+						   static_cast<float>(view.shiftY * scale - previousView.shiftY)};
+
+	reprojectProgram_->bind();
+	vao_->bind();
+	reprojectProgram_->setUniformValue(previousUniform_, 0);
+	reprojectProgram_->setUniformValue(scaleUniform_, static_cast<float>(scale));
+	reprojectProgram_->setUniformValue(offsetUniform_, offset);
+
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+
+	vao_->release();
+	reprojectProgram_->release();
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void FractalWindow::drawFullField(const fgl::Viewport & view) {
+	const auto symmetry = snapshots_.latest().symmetry ? fgl::findSymmetry(view) : std::nullopt;
+	if (!symmetry) {
+		drawFractal(view);
+		return;
+	}
+
+	// Everything but the mirrored half, framebuffer rows go bottom up
+	glEnable(GL_SCISSOR_TEST);
+	for (const auto & region : fgl::symmetricRegions(view, *symmetry)) {
+		glScissor(region.x, view.height - region.y - region.height, region.width, region.height);
+		drawFractal(view);
+	}
+	glDisable(GL_SCISSOR_TEST);
+
+	// Rotate the source half by 180 degrees into the target, swapped target
+	// bounds make the blit flip both axes. Source and target never overlap.
+	const auto & target = symmetry->target;
+	const auto sourceX = symmetry->sumX - (target.x + target.width - 1);
+	const auto sourceY = symmetry->sumY - (target.y + target.height - 1);
+	const auto sourceBottom = view.height - sourceY - target.height;
+	const auto targetBottom = view.height - target.y - target.height;
+	QOpenGLContext::currentContext()->extraFunctions()->glBlitFramebuffer(
+		sourceX, sourceBottom, sourceX + target.width, sourceBottom + target.height,
+		target.x + target.width, targetBottom + target.height, target.x, targetBottom,
+		GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+void FractalWindow::refineStep(const fgl::Viewport & view) {
+	// Replace the next band of the reprojected image with exact rows
+	const auto bandRows = (view.height + g_refine_passes - 1) / g_refine_passes;
+	const auto rows = std::min(bandRows, view.height - refineRow_);
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(0, view.height - refineRow_ - rows, view.width, rows);
+	drawFractal(view);
+	glDisable(GL_SCISSOR_TEST);
+
+	refineRow_ += rows;
+	if (refineRow_ < view.height) {
+		markDirty();
+	}
+}
+
+void FractalWindow::renderGpu(const fgl::Viewport & view, const fgl::DeepViewport * deep, const fgl::PrecisionTier tier,
+							  const fgl::ColourSettings & colour) {
+	// Recreate both fields on resize, count and |z| need full float precision
+	const QSize size{view.width, view.height};
+	if (!frames_[0] || frames_[0]->size() != size) {
+		for (auto & frame : frames_) {
+			frame = std::make_unique<QOpenGLFramebufferObject>(size, QOpenGLFramebufferObject::NoAttachment, GL_TEXTURE_2D, GL_RG32F);
 		}
-		frame_ = 0;
+		hasPrevious_ = false;
+	}
+
+	{
+		// Named after the tier so its cost shows up on its own
+		const GpuScope scope{*this, fgl::tierName(tier)};
+		glViewport(0, 0, view.width, view.height);
+		updateField(view, deep);
+	}
+
+	// Sampling the field with normalised coordinates upscales it
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer());
+	glViewport(0, 0, outputSize_.width(), outputSize_.height());
+	const GpuScope scope{*this, "colourise"};
+	drawColourise(fieldTexture(), fieldExtent(view), view, colour);
+}
+
+std::optional<fgl::PixelOffset> FractalWindow::fieldPanOffset(const fgl::Viewport & view, const fgl::DeepViewport * deep) const {
+	if (!deep) {
+		return fgl::panOffset(previousView_, view);
+	}
+	// Shifts relative to the previous centre, the absolute ones round the
+	// pan away
+	auto previous = previousView_;
+	previous.shiftX = 0.0;
+	previous.shiftY = 0.0;
+	auto current = view;
+	current.shiftX = (deep->centreX - previousCentreX_).toDouble() * view.zoom;
+	current.shiftY = (deep->centreY - previousCentreY_).toDouble() * view.zoom;
+	return fgl::panOffset(previous, current);
+}
+
+void FractalWindow::updateField(const fgl::Viewport & view, const fgl::DeepViewport * deep) {
+	const auto refining = refineRow_ < view.height;
+	// Passes left mean frames_ does not hold a finished field yet
+	const auto finished = progressivePass_ == fgl::progressivePasses;
+	const auto unchanged = view == previousView_
+		&& (!deep || (deep->centreX == previousCentreX_ && deep->centreY == previousCentreY_));
+	if (hasPrevious_ && unchanged) {
+		// Only the colours changed or the field is still being refined, the
+		// first pass is skipped
+		if (refining) {
+			frames_[currentFrame_]->bind();
+		}
+	} else {
+		auto * previous = frames_[currentFrame_].get();
+		currentFrame_ = 1 - currentFrame_;
+		auto * current = frames_[currentFrame_].get();
+		current->bind();
+
+		if (deep) {
+			updateReference(*deep);
+		}
+
+		progressivePass_ = fgl::progressivePasses;
+		const auto offset = hasPrevious_ && finished ? fieldPanOffset(view, deep) : std::nullopt;
+		if (offset) {
+			// Copy what is still visible, framebuffer rows go bottom up
+			const auto width = view.width - std::abs(offset->dx);
+			const auto height = view.height - std::abs(offset->dy);
+			const QRect source{std::max(0, offset->dx), std::max(0, -offset->dy), width, height};
+			const QRect target{std::max(0, -offset->dx), std::max(0, offset->dy), width, height};
+			QOpenGLFramebufferObject::blitFramebuffer(current, target, previous, source);
+
+			// Only compute the strips the pan uncovered
+			glEnable(GL_SCISSOR_TEST);
+			for (const auto & region : fgl::exposedRegions(view, *offset)) {
+				glScissor(region.x, view.height - region.y - region.height, region.width, region.height);
+				drawField(view, deep);
+			}
+			glDisable(GL_SCISSOR_TEST);
+
+			// The exact rows moved with the pan, row y shows row y + dy. A
+			// strip the pan exposed at the top was just computed exactly.
+			if (refining) {
+				refineRow_ = std::clamp(refineRow_ - offset->dy, 0, view.height);
+			}
+		} else if (zoomReprojection_ && !deep && hasPrevious_ && finished && fgl::sameFractal(previousView_, view)) {
+			// Show the scaled previous frame now and refine it over the next frames
+			drawReprojection(previous->texture(), previousView_, view);
+			refineRow_ = 0;
+		} else if (progressive_ && hasPrevious_) {
+			// The coarse passes go to their own fields
+			progressivePass_ = 0;
+			refineRow_ = view.height;
+		} else if (deep) {
+			// Perturbed pixels are not mirror images of each other
+			drawPerturbation(view);
+			refineRow_ = view.height;
+		} else {
+			drawFullField(view);
+			refineRow_ = view.height;
+		}
+	}
+
+	if (progressivePass_ < fgl::progressivePasses) {
+		refineGpuField(view, deep);
+	}
+	if (refineRow_ < view.height) {
+		refineStep(view);
+	}
+}
+
+void FractalWindow::refineGpuField(const fgl::Viewport & view, const fgl::DeepViewport * deep) {
+	// Like the CPU passes every pass after the first only computes the pixels
+	// off the grid of the one before and copies the others from its field
+	if (progressivePass_ > 0) {
+		previousField_ = coarseFields_[static_cast<size_t>(progressivePass_ - 1)]->texture();
+	}
+	if (progressivePass_ + 1 == fgl::progressivePasses) {
+		frames_[currentFrame_]->bind();
+		glViewport(0, 0, view.width, view.height);
+		if (deep) {
+			drawPerturbation(view);
+		} else {
+			drawFullField(view);
+		}
+	} else {
+		// Texel t holds view pixel t * stride
+		fieldStride_ = fgl::progressiveStride(progressivePass_);
+		const QSize size{(view.width + fieldStride_ - 1) / fieldStride_, (view.height + fieldStride_ - 1) / fieldStride_};
+		auto & field = coarseFields_[static_cast<size_t>(progressivePass_)];
+		if (!field || field->size() != size) {
+			field = std::make_unique<QOpenGLFramebufferObject>(size, QOpenGLFramebufferObject::NoAttachment, GL_TEXTURE_2D, GL_RG32F);
+		}
+		field->bind();
+		glViewport(0, 0, size.width(), size.height());
+		drawField(view, deep);
+	}
+	fieldStride_ = 1;
+	previousField_ = 0;
+
+	// Show this pass, then go on with the next one
+	++progressivePass_;
+	if (progressivePass_ < fgl::progressivePasses) {
+		markDirty();
+	}
+}
+
+GLuint FractalWindow::fieldTexture() const {
+	if (progressivePass_ < fgl::progressivePasses) {
+		return coarseFields_[static_cast<size_t>(progressivePass_ - 1)]->texture();
+	}
+	return frames_[currentFrame_]->texture();
+}
+
+QVector2D FractalWindow::fieldExtent(const fgl::Viewport & view) const {
+	// Output pixel x shows texel x / stride of a coarse field
+	if (progressivePass_ < fgl::progressivePasses) {
+		const auto size = coarseFields_[static_cast<size_t>(progressivePass_ - 1)]->size();
+		const auto stride = static_cast<float>(fgl::progressiveStride(progressivePass_ - 1));
+		return {static_cast<float>(view.width) / (stride * static_cast<float>(size.width())),
+				static_cast<float>(view.height) / (stride * static_cast<float>(size.height()))};
+	}
+	return {1.0f, 1.0f};
+}
+
+void FractalWindow::renderCpu(const fgl::Viewport & viewport, const fgl::DeepViewport * deep, const fgl::PrecisionTier tier,
+							  const fgl::ColourSettings & colour) {
+	const auto pixelCount = static_cast<size_t>(viewport.width) * static_cast<size_t>(viewport.height);
+	const auto offset = hasPrevious_ && cpuIterations_.size() == pixelCount ? fieldPanOffset(viewport, deep) : std::nullopt;
+	cpuIterations_.resize(pixelCount);
+	cpuPixels_.resize(pixelCount);
+
+	// Lazy init worker threads, new options replace the pool between frames
+	// while none of its tasks run
+	const auto & settings = snapshots_.latest();
+	if (!tilePool_ || settings.pool != poolOptions_) {
+		tilePool_.reset();
+		poolOptions_ = settings.pool;
+		tilePool_ = std::make_unique<fgl::TilePool>(poolOptions_);
+	}
+
+	fgl::RenderOptions options;
+	options.pool = tilePool_.get();
+	options.periodicityTolerance = periodicityTolerance_;
+	options.symmetry = settings.symmetry;
+	options.subdivide = settings.subdivide;
+	if (tier == fgl::PrecisionTier::CpuDouble) {
+		options.precision = fgl::Precision::Double;
+	} else if (tier == fgl::PrecisionTier::CpuDoubleDouble) {
+		options.precision = fgl::Precision::DoubleDouble;
+	}
+	const auto unchanged = viewport == previousView_
+		&& (!deep || (deep->centreX == previousCentreX_ && deep->centreY == previousCentreY_));
+	const auto refining = progressivePass_ < fgl::progressivePasses;
+	const auto computing = !(offset && unchanged) || refining;
+	if (!(offset && unchanged)) {
+		progressivePass_ = fgl::progressivePasses;
+	}
+	QElapsedTimer fieldTime;
+	fieldTime.start();
+	if (offset && unchanged) {
+		// Only the colours changed or passes are left, the iterations are
+		// still valid
+	} else if (tier == fgl::PrecisionTier::CpuPerturbation) {
+		// Perturbation renders whole views, one reference orbit serves all rows
+		fgl::DeepOptions deepOptions;
+		deepOptions.pool = tilePool_.get();
+		fgl::renderDeep(*deep, cpuIterations_, deepOptions);
+	} else if (offset && !refining) {
+		// Reuse the previous iterations and only compute the uncovered strips
+		fgl::translateBuffer(cpuIterations_, viewport.width, viewport.height, *offset);
+		for (const auto & region : fgl::exposedRegions(viewport, *offset)) {
+			if (deep) {
+				fgl::renderJulia(*deep, region, cpuIterations_, options);
+			} else {
+				fgl::renderJulia(viewport, region, cpuIterations_, options);
+			}
+		}
+	} else if (tier == fgl::PrecisionTier::CpuFloat && hasPrevious_ && fgl::sameOrbits(previousView_, viewport)) {
+		// Only the iteration cap changed, the orbits are kept in float
+		orbits_.render(viewport, cpuIterations_, options);
+	} else if (deep) {
+		fgl::renderJulia(*deep, cpuIterations_, options);
+	} else if (progressive_ && hasPrevious_ && !settings.subdivide) {
+		// The previous frame stays up until the first pass is done
+		progressivePass_ = 0;
+	} else {
+		fgl::renderJulia(viewport, cpuIterations_, options);
+	}
+	if (progressivePass_ < fgl::progressivePasses) {
+		refineCpuField(viewport, options);
+	}
+	if (computing) {
+		cpuTierCosts_[static_cast<size_t>(tier)].record(static_cast<float>(fieldTime.nsecsElapsed()) * 1e-6f);
+	}
+
+	if (progressivePass_ == 0) {
+		// The first pass was cancelled, keep the previous frame, scaled to
+		// the new size if it changed
+		if (cpuTexture_) {
+			const GpuScope scope{*this, "blit"};
+			drawTexture(cpuTexture_->textureId(), true);
+		}
+		return;
+	}
+
+	// Recreate texture storage on resize
+	if (!cpuTexture_ || cpuTexture_->width() != viewport.width || cpuTexture_->height() != viewport.height) {
+		cpuTexture_ = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+		cpuTexture_->setFormat(QOpenGLTexture::RGBA8_UNorm);
+		cpuTexture_->setSize(viewport.width, viewport.height);
+		cpuTexture_->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+		cpuTexture_->allocateStorage();
+	}
+
+	if (progressivePass_ < fgl::progressivePasses) {
+		// Blow the samples so far up to blocks
+		const auto stride = fgl::progressiveStride(std::max(progressivePass_ - 1, 0));
+		cpuPreview_.resize(pixelCount);
+		fgl::fillProgressive(cpuIterations_, viewport.width, viewport.height, stride, cpuPreview_);
+		fgl::colourise(viewport, cpuPreview_, cpuPixels_, colour);
+	} else {
+		fgl::colourise(viewport, cpuIterations_, cpuPixels_, colour);
+	}
+	{
+		const GpuScope scope{*this, "upload"};
+		cpuTexture_->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, cpuPixels_.data());
+	}
+
+	const GpuScope scope{*this, "blit"};
+	drawTexture(cpuTexture_->textureId(), true);
+}
+
+void FractalWindow::refineCpuField(const fgl::Viewport & viewport, const fgl::RenderOptions & options) {
+	// Symmetry halves the last pass, the coarse ones cover the whole view
+	const auto last = progressivePass_ + 1 == fgl::progressivePasses;
+	const auto symmetry = last && options.symmetry ? fgl::findSymmetry(viewport) : std::nullopt;
+	const auto regions = symmetry ? fgl::symmetricRegions(viewport, *symmetry) : std::vector<fgl::Rect>{viewport.bounds()};
+
+	// A newer snapshot stops the pass, its frame then goes on with the same
+	// pass or starts over
+	const auto cancelled = [this] { return snapshots_.hasUpdate(); };
+	for (const auto & region : regions) {
+		if (!fgl::renderProgressivePass(viewport, region, progressivePass_, cpuIterations_, options, cancelled)) {
+			return;
+		}
+	}
+	if (symmetry) {
+		fgl::mirrorBuffer(cpuIterations_, viewport.width, *symmetry);
+	}
+
+	// Show this pass, then go on with the next one
+	++progressivePass_;
+	if (progressivePass_ < fgl::progressivePasses) {
+		markDirty();
 	}
-	++frame_;
 }
 
 void FractalWindow::destroy() {
+	for (auto & frame : frames_) {
+		frame.reset();
+	}
+	for (auto & field : coarseFields_) {
+		field.reset();
+	}
+	hasPrevious_ = false;
+	orbits_.clear();
+	cpuTexture_.reset();
+	orbitTexture_.reset();
+	perturbProgram_.reset();
+	df64Program_.reset();
+	reprojectProgram_.reset();
+	colouriseProgram_.reset();
+	blitProgram_.reset();
 	program_.reset();
+	vao_.reset();
+	tilePool_.reset();
+}
+
+void FractalWindow::invalidate() {
+	hasPrevious_ = false;
 }
 
 void FractalWindow::mousePressEvent(QMouseEvent * e) {
+	const fgl::TraceZone zone{"FractalWindow::mousePressEvent"};
 	isPressed_ = true;
 	mousePressPosition_ = QVector2D(e->localPos());
 }
 
 void FractalWindow::mouseReleaseEvent(QMouseEvent * e) {
+	const fgl::TraceZone zone{"FractalWindow::mouseReleaseEvent"};
 	isPressed_ = false;
-	int xAtRelease = e->x();
-	int yAtRelease = e->y();
-	float dx = xAtRelease - mousePressPosition_.x();
-	float dy = yAtRelease - mousePressPosition_.y();
-	globalShift_ += QVector2D(-2 * dx / (float)width(), 2 * dy / (float)height());
+	// The centre stays on device pixels, not on those of a scaled field
+	const auto shift = dragShift(QVector2D(e->localPos()), devicePixelRatio());
+	centreX_ += fgl::DeepReal{shift.x() / zoom_};
+	centreY_ += fgl::DeepReal{shift.y() / zoom_};
 	shift_ = QVector2D(0, 0);
+	updatePrecisionTier();
+	publishSnapshot();
 }
 
 void FractalWindow::mouseMoveEvent(QMouseEvent * e) {
+	const fgl::TraceZone zone{"FractalWindow::mouseMoveEvent"};
 	if (isPressed_) {
-		int xAtMove = e->x();
-		int yAtMove = e->y();
-		float dx = xAtMove - mousePressPosition_.x();
-		float dy = yAtMove - mousePressPosition_.y();
-		shift_ = QVector2D(-2 * dx / (float)width(), 2 * dy / (float)height());
+		// Whole pixels of the field so the previous frame can be reused
+		shift_ = dragShift(QVector2D(e->localPos()), devicePixelRatio() * static_cast<double>(renderScale_.load()));
+		publishSnapshot();
 	}
 }
 
+QVector2D FractalWindow::dragShift(const QVector2D & position, const double scale) const {
+	const auto pixelWidth = std::max(1.0, std::round(width() * scale));
+	const auto pixelHeight = std::max(1.0, std::round(height() * scale));
+	const auto dx = std::round((position.x() - mousePressPosition_.x()) * scale);
+	const auto dy = std::round((position.y() - mousePressPosition_.y()) * scale);
+	return QVector2D(static_cast<float>(-2 * dx / pixelWidth), static_cast<float>(2 * dy / pixelHeight));
+}
+
 void FractalWindow::wheelEvent(QWheelEvent * e) {
-	float prev = zoom_;
-	float x = float(e->position().x() / width());
-	float y = 1.0f - float(e->position().y() / height());
-	zoom_ = std::max(0.1f, zoom_ + float(e->angleDelta().y() / 1000.) * zoom_);
+	const fgl::TraceZone zone{"FractalWindow::wheelEvent"};
+	const auto prev = zoom_;
+	const auto x = e->position().x() / width();
+	const auto y = 1.0 - e->position().y() / height();
+	zoom_ = std::clamp(zoom_ + e->angleDelta().y() / 1000. * zoom_, 0.1, g_max_zoom);
 
-	globalShift_ = zoom_ / prev * (QVector2D(-1, -1) + globalShift_ + 2 * QVector2D(x, y))
-		- QVector2D(-1, -1) - 2 * QVector2D(x, y);
+	// Keep the point under the cursor in place, in full precision so the
+	// centre survives zooms far beyond a double
+	const auto scale = 1.0 / prev - 1.0 / zoom_;
+	centreX_ += fgl::DeepReal{(2.0 * x - 1.0) * scale};
+	centreY_ += fgl::DeepReal{(2.0 * y - 1.0) * scale};
+	// Steps to a more precise tier right away, back only with room to spare
+	updatePrecisionTier();
+	publishSnapshot();
+}
+
+void FractalWindow::exposeEvent(QExposeEvent * e) {
+	const fgl::TraceZone zone{"FractalWindow::exposeEvent"};
+	// Moving to a screen with another device pixel ratio only exposes
+	if (isExposed()) {
+		updatePrecisionTier();
+		publishSnapshot();
+	}
+	fgl::GLWindow::exposeEvent(e);
 }
 
 void FractalWindow::setIterations(int iterations) {
 	iterations_ = iterations;
+	publishSnapshot();
 }
 
 
 void FractalWindow::setParam1(float param1) {
 	param1_ = param1;
+	publishSnapshot();
 }
 
 void FractalWindow::setParam2(float param2) {
 	param2_ = param2;
+	publishSnapshot();
 }
 
 void FractalWindow::setParam3(float param3) {
 	param3_ = param3;
+	publishSnapshot();
 }
 
 void FractalWindow::setFpsCounter(QLabel * fpsLabelValue) {
 	fpsLabelValue_ = fpsLabelValue;
 }
+
+void FractalWindow::setFrameStatsLabel(QLabel * frameStatsLabelValue) {
+	frameStatsLabelValue_ = frameStatsLabelValue;
+}
+
+void FractalWindow::setBackend(Backend backend) {
+	backend_ = backend;
+	resetPrecisionPolicy();
+}
+
+void FractalWindow::setShaderPrecision(ShaderPrecision precision) {
+	shaderPrecision_ = precision;
+	resetPrecisionPolicy();
+}
+
+void FractalWindow::setZoom(double zoom) {
+	zoom_ = std::clamp(zoom, 0.1, g_max_zoom);
+	updatePrecisionTier();
+	publishSnapshot();
+}
+
+void FractalWindow::setCentre(double x, double y) {
+	centreX_ = fgl::DeepReal{x};
+	centreY_ = fgl::DeepReal{y};
+	updatePrecisionTier();
+	publishSnapshot();
+}
+
+void FractalWindow::setZoomReprojection(bool enabled) {
+	Q_ASSERT(!isVisible());
+	zoomReprojection_ = enabled;
+}
+
+void FractalWindow::setProgressiveRefinement(bool enabled) {
+	Q_ASSERT(!isVisible());
+	progressive_ = enabled;
+}
+
+void FractalWindow::setFrameBudget(double ms) {
+	Q_ASSERT(!isVisible());
+	frameBudget_ = ms;
+	if (ms > 0.0) {
+		fgl::ResolutionGovernorOptions options;
+		options.targetMs = static_cast<float>(ms);
+		governor_ = fgl::ResolutionGovernor{options};
+	}
+}
+
+void FractalWindow::setPalette(fgl::Palette palette) {
+	colour_.palette = palette;
+	publishSnapshot();
+}
+
+void FractalWindow::setContrast(float contrast) {
+	colour_.contrast = contrast;
+	publishSnapshot();
+}
+
+void FractalWindow::setColourCycle(float cycle) {
+	colour_.cycle = cycle;
+	publishSnapshot();
+}
+
+void FractalWindow::setPeriodicityTolerance(double tolerance) {
+	Q_ASSERT(!isVisible());
+	periodicityTolerance_ = tolerance;
+}
+
+void FractalWindow::setSymmetry(bool enabled) {
+	symmetry_ = enabled;
+	publishSnapshot();
+}
+
+void FractalWindow::setSubdivide(bool enabled) {
+	subdivide_ = enabled;
+	publishSnapshot();
+}
+
+void FractalWindow::setTilePoolOptions(const fgl::TilePoolOptions & options) {
+	tilePoolOptions_ = options;
+	publishSnapshot();
+}
+
+void FractalWindow::publishSnapshot() {
+	// Frames may render scaled until the view did not change for g_idle_ms,
+	// colours alone do not change the field
+	auto next = snapshot();
+	if (!(next.view == published_.view && next.centreX == published_.centreX && next.centreY == published_.centreY
+		  && next.tier == published_.tier)) {
+		interactive_ = true;
+		idleTimer_.start();
+	}
+	next.interactive = interactive_;
+	published_ = next;
+
+	// Never blocks, the render thread picks it up with its next frame
+	snapshots_.publish(published_);
+	fgl::traceInstant("snapshot published");
+	markDirty();
+}
+
+void FractalWindow::settle() {
+	// Only scaled frames need another one
+	interactive_ = false;
+	published_ = snapshot();
+	snapshots_.publish(published_);
+	if (renderScale_ < 1.0f) {
+		markDirty();
+	}
+}
+
+void FractalWindow::updateRenderScale(const fgl::PrecisionTier tier, const bool interactive) {
+	if (!interactive) {
+		// Timings of native frames would pass for scaled ones
+		governor_.hold();
+		return;
+	}
+	const auto * cost = tierCost(tier);
+	if (cost != nullptr && cost->recorded() != governorSamples_) {
+		governorSamples_ = cost->recorded();
+		governor_.update(cost->latest());
+	}
+}
+
+FractalWindow::Snapshot FractalWindow::snapshot() const {
+	// The drag in progress moves the centre as well
+	return {viewport(),
+			colour_,
+			centreX_ + fgl::DeepReal{shift_.x() / zoom_},
+			centreY_ + fgl::DeepReal{shift_.y() / zoom_},
+			precisionPolicy_.tier(),
+			interactive_,
+			backend_,
+			symmetry_,
+			subdivide_,
+			tilePoolOptions_};
+}
+
+gsl::span<const fgl::PrecisionTier> FractalWindow::availableTiers() const {
+	if (backend_ == Backend::Cpu) {
+		return fgl::cpuTiers();
+	}
+	switch (shaderPrecision_) {
+		case ShaderPrecision::Float:
+			return g_float_shader;
+		case ShaderPrecision::Df64:
+			return g_df64_shader;
+		case ShaderPrecision::Auto:
+			break;
+	}
+	return fgl::gpuTiers();
+}
+
+void FractalWindow::resetPrecisionPolicy() {
+	precisionPolicy_ = fgl::PrecisionPolicy{availableTiers()};
+	updatePrecisionTier();
+	publishSnapshot();
+}
+
+void FractalWindow::sizeChanged() {
+	const fgl::TraceZone zone{"FractalWindow::sizeChanged"};
+	updatePrecisionTier();
+	publishSnapshot();
+}
+
+void FractalWindow::updatePrecisionTier() {
+	precisionPolicy_.update(viewport());
+}
+
+fgl::PrecisionTier FractalWindow::precisionTier() const {
+	return precisionPolicy_.tier();
+}
+
+const fgl::TimingSeries * FractalWindow::tierCost(const fgl::PrecisionTier tier) const {
+	// Runs on both threads, the tier tells the backend apart
+	const auto cpuTiers = fgl::cpuTiers();
+	if (std::find(cpuTiers.begin(), cpuTiers.end(), tier) != cpuTiers.end()) {
+		const auto & series = cpuTierCosts_[static_cast<size_t>(tier)];
+		return series.summary().count > 0 ? &series : nullptr;
+	}
+	const auto & stats = frameStats();
+	for (size_t pass = 0; pass < stats.gpuPassCount(); ++pass) {
+		if (stats.gpuPassName(pass) == fgl::tierName(tier)) {
+			return &stats.gpuSeries(pass);
+		}
+	}
+	return nullptr;
+}
+
+fgl::Viewport FractalWindow::viewport() const {
+	const auto retinaScale = devicePixelRatio();
+
+	fgl::Viewport viewport;
+	viewport.width = static_cast<int>(width() * retinaScale);
+	viewport.height = static_cast<int>(height() * retinaScale);
+	viewport.zoom = zoom_;
+	viewport.shiftX = centreX_.toDouble() * zoom_ + shift_.x();
+	viewport.shiftY = centreY_.toDouble() * zoom_ + shift_.y();
+	viewport.param1 = param1_;
+	viewport.param2 = param2_;
+	viewport.param3 = param3_;
+	viewport.iterations = iterations_;
+	return viewport;
+}
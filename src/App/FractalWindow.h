@@ -1,9 +1,20 @@
 #pragma once
 
 #include <Base/GLWindow.hpp>
+#include <Core/DeepZoom.hpp>
+#include <Core/OrbitBuffer.hpp>
+#include <Core/PanReuse.hpp>
+#include <Core/Palette.hpp>
+#include <Core/PrecisionTier.hpp>
+#include <Core/Progressive.hpp>
+#include <Core/ResolutionGovernor.hpp>
+#include <Core/TilePool.hpp>
+#include <Core/TripleBuffer.hpp>
+#include <Core/Viewport.hpp>
 
 #include <QMatrix4x4>
 #include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLTexture>
@@ -13,56 +24,330 @@
 #include <QElapsedTimer>
 #include <QTime>
 #include <QLabel>
+#include <QTimer>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <vector>
 
 class FractalWindow final : public fgl::GLWindow
 {
 
+public:
+	enum class Backend
+	{
+		Gpu,
+		Cpu,
+	};
+
+	// Shader of the GPU iteration field. Auto lets the precision policy go
+	// from float to df64 to perturbation as the zoom deepens, the others
+	// force one variant at any depth for comparisons.
+	enum class ShaderPrecision
+	{
+		Auto,
+		Float,
+		Df64,
+	};
+
+public:
+	explicit FractalWindow(QWindow * parent = nullptr);
+	~FractalWindow() override;
+
 public:
 	void init() override;
 	void render() override;
 	void destroy() override;
+	void invalidate() override;
 	void setIterations(int iterations);
 	void setParam1(float param1);
 	void setParam2(float param2);
 	void setParam3(float param3);
 	void setFpsCounter(QLabel * fpsLabelValue);
+	// Shows frame time percentiles next to the FPS, nullptr hides them.
+	void setFrameStatsLabel(QLabel * frameStatsLabelValue);
+	void setBackend(Backend backend);
+	void setShaderPrecision(ShaderPrecision precision);
+	// Moves the view, for headless runs of a particular depth.
+	void setZoom(double zoom);
+	void setCentre(double x, double y);
+	void setTilePoolOptions(const fgl::TilePoolOptions & options);
+	// Show the scaled previous frame on zoom and refine it over the next
+	// frames. Set before the window is shown.
+	void setZoomReprojection(bool enabled);
+	// Compute changed views at 1/8, 1/4, 1/2 and full resolution over
+	// successive frames. Set before the window is shown.
+	void setProgressiveRefinement(bool enabled);
+	// Time of the field pass in milliseconds the window trades resolution
+	// for while the view changes, 0 always renders at native resolution.
+	// Set before the window is shown.
+	void setFrameBudget(double ms);
+	// Fraction of a pixel that counts as a repeating orbit, 0 disables
+	// periodicity checking on both backends. Set before the window is shown.
+	void setPeriodicityTolerance(double tolerance);
+	// Compute only one half of centred views and mirror it (z -> -z), off
+	// centre views fall back to computing every pixel.
+	void setSymmetry(bool enabled);
+	// CPU backend only: compute rectangle borders and fill uniform ones.
+	// Faster on interior or exterior views only, see renderSubdivided().
+	void setSubdivide(bool enabled);
+	// Colour changes only rerun the colourise pass.
+	void setPalette(fgl::Palette palette);
+	void setContrast(float contrast);
+	void setColourCycle(float cycle);
+
+	// Current view and fractal parameters in device pixels, GUI thread only.
+	fgl::Viewport viewport() const;
+	// Tier the precision policy picked for the current view, GUI thread only.
+	fgl::PrecisionTier precisionTier() const;
 
 protected:
 	void mousePressEvent(QMouseEvent * e) override;
 	void mouseReleaseEvent(QMouseEvent * e) override;
 	void mouseMoveEvent(QMouseEvent * e) override;
 	void wheelEvent(QWheelEvent * e) override;
+	// The pixel spacing follows the device pixel ratio as well.
+	void exposeEvent(QExposeEvent * e) override;
+
+private:
+	// Everything a frame depends on, published as one value.
+	struct Snapshot
+	{
+		fgl::Viewport view;
+		fgl::ColourSettings colour;
+		// View centre in full precision, view.shift is its rounded double.
+		fgl::DeepReal centreX;
+		fgl::DeepReal centreY;
+		fgl::PrecisionTier tier = fgl::PrecisionTier::FloatShader;
+		// Something changed within g_idle_ms, the frame may render scaled.
+		bool interactive = false;
+		Backend backend = Backend::Gpu;
+		bool symmetry = true;
+		bool subdivide = false;
+		// renderCpu() recreates the pool when these change.
+		fgl::TilePoolOptions pool;
+	};
+
+	// Sample grid uniforms every field shader has, see diffuse.fs.
+	struct GridUniforms
+	{
+		GLint viewSize = -1;
+		GLint stride = -1;
+		GLint reuse = -1;
+		GLint previousField = -1;
+	};
+
+private:
+	Snapshot snapshot() const;
+	void publishSnapshot();
+	// Publishes the current view once more for native resolution.
+	void settle();
+	// Feeds the field pass time of the last frame to the governor.
+	void updateRenderScale(fgl::PrecisionTier tier, bool interactive);
+	// Tiers the backend and shader precision allow, cheapest first.
+	gsl::span<const fgl::PrecisionTier> availableTiers() const;
+	void resetPrecisionPolicy();
+	// The pixel spacing follows the size, also of hidden headless windows
+	// that never get a resize event.
+	void sizeChanged();
+	// Lets the policy pick a tier for the current view.
+	void updatePrecisionTier();
+	// Recent costs of the field pass in the tier, nullptr before it ran.
+	const fgl::TimingSeries * tierCost(fgl::PrecisionTier tier) const;
+	void updateFpsCounter();
+	// View shift of the drag to position, in whole pixels of a field scale
+	// times the window size.
+	QVector2D dragShift(const QVector2D & position, double scale) const;
+	void drawFractal(const fgl::Viewport & view);
+	void drawFractalDf64(const fgl::Viewport & view);
+	void drawTexture(GLuint texture, bool topDown);
+	void drawColourise(GLuint field, const QVector2D & extent, const fgl::Viewport & view, const fgl::ColourSettings & colour);
+	void drawReprojection(GLuint previous, const fgl::Viewport & previousView, const fgl::Viewport & view);
+	void refineStep(const fgl::Viewport & view);
+	void drawFullField(const fgl::Viewport & view);
+	// Deep views: computes and uploads the reference orbit of the centre
+	// once per view, then every field pass draws with perturb.fs.
+	void updateReference(const fgl::DeepViewport & deep);
+	void drawPerturbation(const fgl::Viewport & view);
+	// Grid of the field pass being drawn, from fieldStride_ and previousField_.
+	void setGridUniforms(QOpenGLShaderProgram & program, const GridUniforms & uniforms, const fgl::Viewport & view);
+	// Either field pass, deep is nullptr unless the view needs perturbation.
+	void drawField(const fgl::Viewport & view, const fgl::DeepViewport * deep);
+	// Pan since the previous frame, deep views measure it in full precision.
+	std::optional<fgl::PixelOffset> fieldPanOffset(const fgl::Viewport & view, const fgl::DeepViewport * deep) const;
+	// First pass, brings the current iteration field up to date with view.
+	void updateField(const fgl::Viewport & view, const fgl::DeepViewport * deep);
+	// Deep tiers get the view with its full precision centre, others nullptr.
+	void renderGpu(const fgl::Viewport & view, const fgl::DeepViewport * deep, fgl::PrecisionTier tier,
+				   const fgl::ColourSettings & colour);
+	void renderCpu(const fgl::Viewport & viewport, const fgl::DeepViewport * deep, fgl::PrecisionTier tier,
+				   const fgl::ColourSettings & colour);
+	// Runs progressivePass_ and schedules the next frame for the one after.
+	void refineCpuField(const fgl::Viewport & viewport, const fgl::RenderOptions & options);
+	void refineGpuField(const fgl::Viewport & view, const fgl::DeepViewport * deep);
+	// Iteration field of the last finished pass.
+	GLuint fieldTexture() const;
+	// Part of fieldTexture() that covers the view.
+	QVector2D fieldExtent(const fgl::Viewport & view) const;
 
 private:
 	GLint shiftUniform_ = -1;
+	GLint periodEpsilonUniform_ = -1;
 	GLint zoomUniform_ = -1;
 	GLint iterationsUniform_ = -1;
 	GLint param1Uniform_ = -1;
 	GLint param2Uniform_ = -1;
 	GLint param3Uniform_ = -1;
+	GLint imageUniform_ = -1;
+	GLint topDownUniform_ = -1;
+	GLint previousUniform_ = -1;
+	GLint scaleUniform_ = -1;
+	GLint offsetUniform_ = -1;
+	GLint fieldUniform_ = -1;
+	GLint fieldTopDownUniform_ = -1;
+	GLint fieldIterationsUniform_ = -1;
+	GLint paletteUniform_ = -1;
+	GLint contrastUniform_ = -1;
+	GLint cycleUniform_ = -1;
+	GLint df64CentreXUniform_ = -1;
+	GLint df64CentreYUniform_ = -1;
+	GLint df64InvZoomUniform_ = -1;
+	GLint df64IterationsUniform_ = -1;
+	GLint df64ConstantUniform_ = -1;
+	GLint df64PeriodEpsilonUniform_ = -1;
+	GLint perturbIterationsUniform_ = -1;
+	GLint constantUniform_ = -1;
+	GLint orbitUniform_ = -1;
+	GLint orbitWidthUniform_ = -1;
+	GLint orbitLastUniform_ = -1;
+	GLint pixelMantissaUniform_ = -1;
+	GLint pixelExponentUniform_ = -1;
+	GLint seriesSkipUniform_ = -1;
+	GLint seriesScaleUniform_ = -1;
+	GLint seriesAUniform_ = -1;
+	GLint seriesBUniform_ = -1;
+	GLint seriesCUniform_ = -1;
+	GLint seriesExponentUniform_ = -1;
+	GridUniforms gridUniforms_;
+	GridUniforms df64GridUniforms_;
+	GridUniforms perturbGridUniforms_;
+	GLint fieldExtentUniform_ = -1;
 
 	int iterations_ = 100;
 	float param1_ = 2.0;
 	float param2_ = (float)(-0.345);
 	float param3_ = (float)0.654;
-	float zoom_ = (float)0.4;
+	// Double so deep zooms keep going, the shaders only ever see 1 / zoom_
+	// split into mantissa and exponent.
+	double zoom_ = 0.4;
+	// Drag in progress, in the units of Viewport::shiftX.
 	QVector2D shift_{0., 0.};
+	fgl::ColourSettings colour_;
 
-	QLabel * fpsLabelValue_;
+	QLabel * fpsLabelValue_ = nullptr;
+	QLabel * frameStatsLabelValue_ = nullptr;
+
+	// Written by the GUI thread on every change, read by render().
+	fgl::TripleBuffer<Snapshot> snapshots_;
 
 	QOpenGLBuffer vbo_{QOpenGLBuffer::Type::VertexBuffer};
 	QOpenGLBuffer ibo_{QOpenGLBuffer::Type::IndexBuffer};
-	QOpenGLVertexArrayObject vao_;
+	// Created in init() so it lives on the render thread.
+	std::unique_ptr<QOpenGLVertexArrayObject> vao_ = nullptr;
 
 	std::unique_ptr<QOpenGLShaderProgram> program_ = nullptr;
+	// Double-float variant of program_ for views float cannot resolve.
+	std::unique_ptr<QOpenGLShaderProgram> df64Program_ = nullptr;
+	ShaderPrecision shaderPrecision_ = ShaderPrecision::Auto;
+	bool df64Field_ = false;
+	// Picks the tier on the GUI thread, every snapshot carries its choice.
+	fgl::PrecisionPolicy precisionPolicy_{fgl::gpuTiers()};
+	// Tier of previousView_, a new one starts the field over.
+	fgl::PrecisionTier previousTier_ = fgl::PrecisionTier::FloatShader;
+	// Wall time of the CPU field passes per tier, GPU tiers are timed as GPU
+	// passes named after them.
+	std::array<fgl::TimingSeries, fgl::precisionTierCount> cpuTierCosts_;
+	// Second pass, maps the iteration field to colours.
+	std::unique_ptr<QOpenGLShaderProgram> colouriseProgram_ = nullptr;
+
+	// Iteration fields of the last two frames, panning copies the overlap
+	// from the previous one.
+	std::array<std::unique_ptr<QOpenGLFramebufferObject>, 2> frames_;
+	size_t currentFrame_ = 0;
+	fgl::Viewport previousView_;
+	bool hasPrevious_ = false;
+
+	// Zoom reprojection, rows above refineRow_ are exact.
+	bool zoomReprojection_ = true;
+	std::unique_ptr<QOpenGLShaderProgram> reprojectProgram_ = nullptr;
+	int refineRow_ = 0;
+
+	// Perturbation for views beyond float precision.
+	std::unique_ptr<QOpenGLShaderProgram> perturbProgram_ = nullptr;
+	std::unique_ptr<QOpenGLTexture> orbitTexture_ = nullptr;
+	std::vector<float> orbitTexels_;
+	fgl::ReferenceOrbit reference_;
+	// Centre of previousView_, only meaningful if previousDeep_.
+	bool previousDeep_ = false;
+	fgl::DeepReal previousCentreX_;
+	fgl::DeepReal previousCentreY_;
+
+	// CPU backend renders with fractal-core and uploads the result.
+	Backend backend_ = Backend::Gpu;
+	std::unique_ptr<QOpenGLShaderProgram> blitProgram_ = nullptr;
+	std::unique_ptr<QOpenGLTexture> cpuTexture_ = nullptr;
+	std::vector<std::uint32_t> cpuIterations_;
+	std::vector<std::uint32_t> cpuPixels_;
+	// Progressive refinement, the passes before progressivePass_ are done.
+	// On the CPU cpuIterations_ holds their samples and cpuPreview_ them
+	// blown up to blocks. The GPU renders the coarse ones into fields of
+	// 1 / progressiveStride() the size and the last one into frames_.
+	bool progressive_ = true;
+	int progressivePass_ = fgl::progressivePasses;
+	std::array<std::unique_ptr<QOpenGLFramebufferObject>, fgl::progressivePasses - 1> coarseFields_;
+	// Field pass being drawn: every fieldStride_-th pixel of the view, with
+	// previousField_ set its samples are copied instead of computed again.
+	int fieldStride_ = 1;
+	GLuint previousField_ = 0;
+	std::vector<std::uint32_t> cpuPreview_;
+	// Lets the iterations slider continue orbits instead of restarting them.
+	fgl::OrbitBuffer orbits_;
+	double periodicityTolerance_ = 1e-3;
+	// GUI thread values, render() reads them from the snapshot.
+	fgl::TilePoolOptions tilePoolOptions_;
+	bool symmetry_ = true;
+	bool subdivide_ = false;
+	// Render thread only, created with poolOptions_.
+	std::unique_ptr<fgl::TilePool> tilePool_ = nullptr;
+	fgl::TilePoolOptions poolOptions_;
+
+	// Dynamic resolution, interactive frames render the field at
+	// governor_.scale() of the framebuffer size and upscale it.
+	double frameBudget_ = 16.0;
+	fgl::ResolutionGovernor governor_;
+	// Tier cost samples the governor has seen.
+	std::uint64_t governorSamples_ = 0;
+	// Size of the framebuffer this frame, the field may be smaller.
+	QSize outputSize_;
+	std::atomic<float> renderScale_{1.0f};
+	// Snapshot view previousView_ was scaled from.
+	fgl::Viewport previousSnapshotView_;
+	bool interactive_ = false;
+	QTimer idleTimer_;
+	// Last snapshot published, GUI thread only.
+	Snapshot published_;
 
-	size_t frame_ = 0;
+	// Frames are counted on the render thread and shown by a GUI timer.
+	std::atomic<size_t> frame_{0};
 	QElapsedTimer m_time;
-	float fps = 0;
+	QTimer fpsTimer_;
 
 	QVector2D mousePressPosition_{0., 0.};
 	bool isPressed_ = false;
-	QVector2D globalShift_{0., 0.};
+	// Plane position of the view centre once the drag is released.
+	fgl::DeepReal centreX_;
+	fgl::DeepReal centreY_;
 };
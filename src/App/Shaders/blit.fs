@@ -0,0 +1,10 @@
+#version 330 core
+
+in vec2 tex_coord;
+out vec4 out_col;
+
+uniform sampler2D image;
+
+void main() {
+	out_col = texture(image, tex_coord);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+layout(location=0) in vec2 pos;
+
+out vec2 tex_coord;
+
+// CPU buffers keep the top row first, framebuffers the bottom one.
+uniform bool top_down;
+
+void main() {
+	tex_coord = pos * 0.5 + 0.5;
+	if (top_down) {
+		tex_coord.y = 1.0 - tex_coord.y;
+	}
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
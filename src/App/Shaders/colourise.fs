@@ -0,0 +1,46 @@
+#version 330 core
+
+in vec2 tex_coord;
+out vec4 out_col;
+
+// Written by diffuse.fs: iteration count and final |z|.
+uniform sampler2D field;
+// Part of the field covering the view, coarse fields round their size up.
+uniform vec2 field_extent;
+uniform int iterations;
+// Same meaning as fgl::ColourSettings.
+uniform int palette;
+uniform float contrast;
+uniform float cycle;
+
+const float PI = 3.14159265358979;
+
+vec3 cosine_palette(float t, vec3 c, vec3 d) {
+	return vec3(0.5) + vec3(0.5) * cos(2.0 * PI * (c * t + d));
+}
+
+void main() {
+	vec2 value = texture(field, tex_coord * field_extent).xy;
+	float count = value.x;
+	float bailout = float(max(iterations, 2));
+
+	// Grey keeps the original out_col = vec3(count / iterations)
+	float t = count / float(iterations);
+	bool inside = count >= float(iterations);
+	if (palette != 0 && !inside && value.y > 1.0) {
+		// Smooth count removes the banding of integer iterations
+		t = (count + 1.0 - log2(log(value.y) / log(bailout))) / float(iterations);
+	}
+	t = pow(clamp(t, 0.0, 1.0), contrast);
+	if (cycle != 0.0) {
+		t = fract(t + cycle);
+	}
+
+	vec3 colour = vec3(t);
+	if (palette == 1) {
+		colour = inside ? vec3(0.0) : cosine_palette(t, vec3(1.0, 0.7, 0.4), vec3(0.0, 0.15, 0.2));
+	} else if (palette == 2) {
+		colour = inside ? vec3(0.0) : cosine_palette(t, vec3(1.0), vec3(0.5, 0.6, 0.7));
+	}
+	out_col = vec4(colour, 1.0);
+}
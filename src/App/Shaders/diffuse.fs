@@ -1,15 +1,36 @@
 #version 330 core
 
-in vec2 vert_pos;
-out vec4 out_col;
+// Iteration count and final |z|, colourise.fs turns it into colour.
+out vec2 out_field;
 
+uniform float zoom;
+uniform vec2 shift;
 uniform int iterations;
 uniform float param1;
 uniform float param2;
 uniform float param3;
+// Orbits returning this close to a saved point are cycles, 0 disables it.
+uniform float period_epsilon;
+// Texel t of the field holds view pixel t * stride, the coarse progressive
+// passes render every stride-th pixel. With reuse set the even texels are
+// the samples of the previous pass, texel t / 2 of previous_field.
+uniform vec2 view_size;
+uniform int stride;
+uniform bool reuse;
+uniform sampler2D previous_field;
 
-float julia(vec2 uv) {
-	int j;
+// Offset of the pixel from the view centre, -1 to 1 across the view. Every
+// pass computes it the same way, so a reused sample is the one this pass
+// would have computed.
+vec2 pixel_offset(ivec2 texel) {
+	return (vec2(texel * stride) + 0.5) * 2.0 / view_size - 1.0;
+}
+
+vec2 julia(vec2 uv) {
+	int j = 0;
+	// Brent's cycle detection, the saved point moves at 1, 2, 4, 8, ...
+	vec2 saved = uv;
+	int next_save = 1;
 	for (int i = 0; i < iterations; i++){
 		j++;
 		vec2 c = vec2(param2 * 0.001, param3 * 0.001);
@@ -18,11 +39,27 @@ float julia(vec2 uv) {
 		if (length(uv) > float(iterations)) {
 			break;
 		}
+		if (period_epsilon > 0.0) {
+			vec2 d = uv - saved;
+			if (dot(d, d) < period_epsilon * period_epsilon) {
+				// Interior, it would never escape
+				j = iterations;
+				break;
+			}
+			if (j == next_save) {
+				saved = uv;
+				next_save *= 2;
+			}
+		}
 	}
-	return float(j)/float(iterations);
+	return vec2(float(j), length(uv));
 }
 
 void main() {
-    float f = julia(vert_pos);
-	out_col = vec4(vec3(f), 1.0);
-}
\ No newline at end of file
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	if (reuse && texel % 2 == ivec2(0)) {
+		out_field = texelFetch(previous_field, texel / 2, 0).xy;
+		return;
+	}
+	out_field = julia((pixel_offset(texel) + shift) / zoom);
+}
@@ -0,0 +1,129 @@
+#version 330 core
+
+// Same iteration as diffuse.fs in double-float arithmetic: every real is the
+// unevaluated sum hi + lo of two floats (x and y of a vec2), which gives 48
+// mantissa bits on hardware without fp64. The error free transformations
+// below need the driver to keep float operations as written.
+// Iteration count and final |z|, colourise.fs turns it into colour.
+out vec2 out_field;
+
+// Plane position of the view centre and 1 / zoom as hi, lo pairs. Passing
+// the centre instead of shift keeps the pixel offset, shift = centre * zoom
+// would be far larger than it.
+uniform vec2 centre_x;
+uniform vec2 centre_y;
+uniform vec2 inv_zoom;
+uniform int iterations;
+uniform vec2 constant;
+// Orbits returning this close to a saved point are cycles, 0 disables it.
+uniform float period_epsilon;
+// Sample grid of the field and the pass it reuses, see diffuse.fs.
+uniform vec2 view_size;
+uniform int stride;
+uniform bool reuse;
+uniform sampler2D previous_field;
+
+// a + b exactly as hi + lo.
+vec2 two_sum(float a, float b) {
+	float s = a + b;
+	float v = s - a;
+	return vec2(s, (a - (s - v)) + (b - v));
+}
+
+// Same as two_sum() for |a| >= |b|.
+vec2 quick_two_sum(float a, float b) {
+	float s = a + b;
+	return vec2(s, b - (s - a));
+}
+
+// Halves of 12 bits whose products are exact (Dekker).
+vec2 split(float a) {
+	float t = 4097.0 * a;
+	float hi = t - (t - a);
+	return vec2(hi, a - hi);
+}
+
+// a * b exactly as hi + lo, GLSL 3.30 has no fma.
+vec2 two_prod(float a, float b) {
+	float p = a * b;
+	vec2 as = split(a);
+	vec2 bs = split(b);
+	return vec2(p, ((as.x * bs.x - p) + as.x * bs.y + as.y * bs.x) + as.y * bs.y);
+}
+
+vec2 df_add(vec2 a, vec2 b) {
+	vec2 s = two_sum(a.x, b.x);
+	vec2 t = two_sum(a.y, b.y);
+	s = quick_two_sum(s.x, s.y + t.x);
+	return quick_two_sum(s.x, s.y + t.y);
+}
+
+vec2 df_add(vec2 a, float b) {
+	vec2 s = two_sum(a.x, b);
+	return quick_two_sum(s.x, s.y + a.y);
+}
+
+vec2 df_mul(vec2 a, vec2 b) {
+	vec2 p = two_prod(a.x, b.x);
+	return quick_two_sum(p.x, p.y + (a.x * b.y + a.y * b.x));
+}
+
+// Splits a.x once instead of twice.
+vec2 df_sqr(vec2 a) {
+	float p = a.x * a.x;
+	vec2 as = split(a.x);
+	float error = ((as.x * as.x - p) + 2.0 * as.x * as.y) + as.y * as.y;
+	return quick_two_sum(p, error + 2.0 * a.x * a.y);
+}
+
+// Same as in diffuse.fs.
+vec2 pixel_offset(ivec2 texel) {
+	return (vec2(texel * stride) + 0.5) * 2.0 / view_size - 1.0;
+}
+
+vec2 julia(vec2 offset) {
+	vec2 x = df_add(centre_x, df_mul(vec2(offset.x, 0.0), inv_zoom));
+	vec2 y = df_add(centre_y, df_mul(vec2(offset.y, 0.0), inv_zoom));
+	float bailout = float(iterations);
+
+	int j = 0;
+	// Brent's cycle detection, the saved point moves at 1, 2, 4, 8, ...
+	vec2 saved_x = x;
+	vec2 saved_y = y;
+	int next_save = 1;
+	for (int i = 0; i < iterations; i++) {
+		j++;
+		// Doubling is exact on both halves
+		vec2 xy = df_mul(x, y) * 2.0;
+		x = df_add(df_add(df_sqr(x), -df_sqr(y)), constant.x);
+		y = df_add(xy, constant.y);
+		if (length(vec2(x.x, y.x)) > bailout) {
+			break;
+		}
+		if (period_epsilon > 0.0) {
+			// The hi halves alone cannot tell points a pixel apart
+			float dx = df_add(x, -saved_x).x;
+			float dy = df_add(y, -saved_y).x;
+			if (dx * dx + dy * dy < period_epsilon * period_epsilon) {
+				// Interior, it would never escape
+				j = iterations;
+				break;
+			}
+			if (j == next_save) {
+				saved_x = x;
+				saved_y = y;
+				next_save *= 2;
+			}
+		}
+	}
+	return vec2(float(j), length(vec2(x.x, y.x)));
+}
+
+void main() {
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	if (reuse && texel % 2 == ivec2(0)) {
+		out_field = texelFetch(previous_field, texel / 2, 0).xy;
+		return;
+	}
+	out_field = julia(pixel_offset(texel));
+}
@@ -0,0 +1,120 @@
+#version 330 core
+
+// Deep zoom variant of diffuse.fs: every pixel iterates its float delta from
+// a reference orbit computed on the CPU in fixed point, see Core/DeepZoom.hpp.
+// Iteration count and final |z|, colourise.fs turns it into colour.
+out vec2 out_field;
+
+uniform int iterations;
+uniform vec2 constant;
+// Reference orbit of the view centre, point i at (i % orbit_width,
+// i / orbit_width). xy is Z_i, z the squared delta length beyond which a
+// pixel continues without the reference.
+uniform sampler2D orbit;
+uniform int orbit_width;
+// Index of the last orbit point, the reference escaped there or hit the cap.
+uniform int orbit_last;
+// Deltas are kept as d * 2^exponent so they survive far below the float
+// range. The delta of a pixel is its offset / zoom, and 1 / zoom is
+// pixel_mantissa * 2^pixel_exponent.
+uniform float pixel_mantissa;
+uniform int pixel_exponent;
+// Series approximation: after series_skip iterations the delta is
+// ((c u + b) u + a) u * 2^series_exponent with u = offset * series_scale.
+uniform int series_skip;
+uniform float series_scale;
+uniform vec2 series_a;
+uniform vec2 series_b;
+uniform vec2 series_c;
+uniform int series_exponent;
+// Sample grid of the field and the pass it reuses, see diffuse.fs.
+uniform vec2 view_size;
+uniform int stride;
+uniform bool reuse;
+uniform sampler2D previous_field;
+
+// d stays between 1 / RESCALE_LIMIT and RESCALE_LIMIT, beyond that its
+// exponent moves.
+const float RESCALE_LIMIT = 4294967296.0;
+
+vec2 complex_mul(vec2 a, vec2 b) {
+	return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+vec4 orbit_point(int i) {
+	return texelFetch(orbit, ivec2(i % orbit_width, i / orbit_width), 0);
+}
+
+// Same as in diffuse.fs.
+vec2 pixel_offset(ivec2 texel) {
+	return (vec2(texel * stride) + 0.5) * 2.0 / view_size - 1.0;
+}
+
+vec2 julia(vec2 offset) {
+	float bailout = float(iterations);
+	vec2 d;
+	int exponent;
+	int j;
+	if (series_skip > 0) {
+		vec2 u = offset * series_scale;
+		d = complex_mul(complex_mul(complex_mul(series_c, u) + series_b, u) + series_a, u);
+		exponent = series_exponent;
+		j = series_skip;
+	} else {
+		d = offset * pixel_mantissa;
+		exponent = pixel_exponent;
+		j = 0;
+	}
+	// Flushes to 0 below the float range, where the d^2 term and the delta
+	// next to Z are far below float resolution anyway.
+	float scale = exp2(float(exponent));
+
+	vec2 z = orbit_point(j).xy + d * scale;
+	while (j < iterations) {
+		vec4 point = orbit_point(j);
+		vec2 delta = d * scale;
+		if (j == orbit_last || dot(delta, delta) > point.z) {
+			// The reference escaped or this orbit left it, the pixels around
+			// are far enough apart for plain floats
+			z = point.xy + delta;
+			while (j < iterations) {
+				j++;
+				z = complex_mul(z, z) + constant;
+				if (length(z) > bailout) {
+					break;
+				}
+			}
+			break;
+		}
+
+		// d' = (2 Z + delta) d
+		d = complex_mul(2.0 * point.xy + delta, d);
+		j++;
+		z = orbit_point(j).xy + d * scale;
+		if (length(z) > bailout) {
+			break;
+		}
+
+		// Shrinking deltas would lose the float exponent range as well
+		float magnitude = max(abs(d.x), abs(d.y));
+		if (magnitude > RESCALE_LIMIT) {
+			d /= RESCALE_LIMIT;
+			exponent += 32;
+			scale = exp2(float(exponent));
+		} else if (magnitude < 1.0 / RESCALE_LIMIT && magnitude > 0.0) {
+			d *= RESCALE_LIMIT;
+			exponent -= 32;
+			scale = exp2(float(exponent));
+		}
+	}
+	return vec2(float(j), length(z));
+}
+
+void main() {
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	if (reuse && texel % 2 == ivec2(0)) {
+		out_field = texelFetch(previous_field, texel / 2, 0).xy;
+		return;
+	}
+	out_field = julia(pixel_offset(texel));
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+in vec2 vert_pos;
+out vec2 out_field;
+
+// Previous iteration field with a mip chain, so zooming out does not alias.
+uniform sampler2D previous;
+// Maps this frame's clip position to the previous frame's one.
+uniform float scale;
+uniform vec2 offset;
+
+void main() {
+	vec2 previous_pos = vert_pos * scale + offset;
+	out_field = texture(previous, previous_pos * 0.5 + 0.5).xy;
+}
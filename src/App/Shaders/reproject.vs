@@ -0,0 +1,10 @@
+#version 330 core
+
+layout(location=0) in vec2 pos;
+
+out vec2 vert_pos;
+
+void main() {
+	vert_pos = pos;
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
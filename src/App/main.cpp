@@ -1,21 +1,189 @@
 #include <QAbstractSlider>
 #include <QApplication>
+#include <QComboBox>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSurfaceFormat>
 #include <QVBoxLayout>
 
 #include "FractalWidget.h"
 #include "FractalWindow.h"
 
+#include <Core/Trace.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <optional>
+
 namespace
 {
 constexpr auto g_sampels = 16;
 constexpr auto g_gl_major_version = 3;
 constexpr auto g_gl_minor_version = 3;
+
+bool hasArgument(int argc, char ** argv, const char * argument) {
+	return std::any_of(argv + 1, argv + argc, [argument](const char * arg) { return std::strcmp(arg, argument) == 0; });
+}
+
+// Headless runs must not need a display, unless a platform was picked
+// explicitly. The offscreen platform of Qt 5 gets its contexts from GLX and
+// so needs an X server, minimalegl on a surfaceless EGL display does not.
+void pickHeadlessPlatform() {
+	if (!qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+		return;
+	}
+	if (!qEnvironmentVariableIsEmpty("DISPLAY")) {
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+		return;
+	}
+	// Qt tries the platforms in order
+	qputenv("QT_QPA_PLATFORM", "minimalegl;offscreen");
+	if (qEnvironmentVariableIsEmpty("EGL_PLATFORM")) {
+		qputenv("EGL_PLATFORM", "surfaceless");
+	}
+}
+
+// Renders without showing the window and collects frame timings, nothing if
+// rendering failed.
+std::optional<QJsonObject> measureHeadless(FractalWindow & window, const QSize & size, int frames, const QString & output) {
+	// The window is never shown, but the precision tier follows its size
+	window.resize(size / window.devicePixelRatio());
+	const auto run = window.renderOffscreen(size, frames);
+	if (run.frameSeconds.empty()) {
+		std::fprintf(stderr,
+					 "Offscreen rendering failed, no OpenGL %d.%d context on the %s platform. Without a display headless runs "
+					 "need the minimalegl platform plugin and a surfaceless EGL driver, otherwise run them under an X "
+					 "server, e.g. xvfb-run.\n",
+					 g_gl_major_version, g_gl_minor_version, qPrintable(QGuiApplication::platformName()));
+		return std::nullopt;
+	}
+
+	auto sorted = run.frameSeconds;
+	std::sort(sorted.begin(), sorted.end());
+	const auto total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+	const auto mean = total / static_cast<double>(sorted.size());
+	const auto pixels = static_cast<double>(size.width()) * static_cast<double>(size.height());
+
+	QJsonArray frameMs;
+	for (const auto seconds : run.frameSeconds) {
+		frameMs.append(seconds * 1e3);
+	}
+	QJsonObject result;
+	result["renderer"] = run.renderer;
+	result["tier"] = fgl::tierName(window.precisionTier());
+	result["width"] = size.width();
+	result["height"] = size.height();
+	result["frames"] = static_cast<int>(sorted.size());
+	result["total_s"] = total;
+	result["mean_ms"] = mean * 1e3;
+	result["median_ms"] = sorted[sorted.size() / 2] * 1e3;
+	result["min_ms"] = sorted.front() * 1e3;
+	result["max_ms"] = sorted.back() * 1e3;
+	result["mpix_per_s"] = pixels / mean * 1e-6;
+	result["frame_ms"] = frameMs;
+
+	if (!output.isEmpty() && !run.image.save(output)) {
+		std::fprintf(stderr, "Could not write %s\n", qPrintable(output));
+		return std::nullopt;
+	}
+	return result;
+}
+
+// Prints the frame timings of a headless run as JSON.
+int runHeadless(FractalWindow & window, const QSize & size, int frames, const QString & output) {
+	const auto result = measureHeadless(window, size, frames, output);
+	if (!result) {
+		return 1;
+	}
+	std::printf("%s", QJsonDocument(*result).toJson(QJsonDocument::Indented).constData());
+	return 0;
+}
+
+// Renders the same view with the float and the df64 shader and prints both
+// runs with the cost of df64 relative to float.
+int comparePrecision(FractalWindow & window, const QSize & size, int frames, const QString & output) {
+	window.setShaderPrecision(FractalWindow::ShaderPrecision::Float);
+	const auto single = measureHeadless(window, size, frames, QString());
+	window.setShaderPrecision(FractalWindow::ShaderPrecision::Df64);
+	const auto df64 = measureHeadless(window, size, frames, output);
+	if (!single || !df64) {
+		return 1;
+	}
+
+	QJsonObject result;
+	result["float"] = *single;
+	result["df64"] = *df64;
+	result["df64_cost"] = (*df64)["median_ms"].toDouble() / (*single)["median_ms"].toDouble();
+	std::printf("%s", QJsonDocument(result).toJson(QJsonDocument::Indented).constData());
+	return 0;
+}
 }// namespace
 
 int main(int argc, char ** argv) {
+	if (hasArgument(argc, argv, "--headless")) {
+		pickHeadlessPlatform();
+	}
 	QApplication app(argc, argv);
 
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	const QCommandLineOption cpuOption("cpu", "Render the fractal on the CPU with fractal-core.");
+	parser.addOption(cpuOption);
+	const QCommandLineOption threadsOption("threads", "Worker threads for CPU rendering, 0 uses all cores.", "count", "0");
+	parser.addOption(threadsOption);
+	const QCommandLineOption pinOption("pin-threads", "Pin CPU rendering workers to cores.");
+	parser.addOption(pinOption);
+	const QCommandLineOption guiThreadOption("gui-thread-render", "Render on the GUI thread instead of a dedicated render thread.");
+	parser.addOption(guiThreadOption);
+	const QCommandLineOption continuousOption("continuous", "Redraw every frame even if nothing changed, for benchmarking.");
+	parser.addOption(continuousOption);
+	const QCommandLineOption noReprojectionOption("no-zoom-reprojection", "Recompute the full frame on every zoom step.");
+	parser.addOption(noReprojectionOption);
+	const QCommandLineOption noProgressiveOption("no-progressive", "Compute changed views at full resolution right away.");
+	parser.addOption(noProgressiveOption);
+	const QCommandLineOption frameBudgetOption("frame-budget", "Field pass time to hold by lowering the resolution while the view changes, 0 keeps native resolution.", "ms", "16");
+	parser.addOption(frameBudgetOption);
+	const QCommandLineOption periodicityOption("periodicity", "Fraction of a pixel within which a returning orbit counts as interior, 0 disables the check.", "tolerance", "0.001");
+	parser.addOption(periodicityOption);
+	const QCommandLineOption noSymmetryOption("no-symmetry", "Compute both halves of centred views instead of mirroring one.");
+	parser.addOption(noSymmetryOption);
+	const QCommandLineOption subdivideOption("subdivide", "CPU backend: skip the insides of rectangles with a uniform border, faster on interior/exterior views only.");
+	parser.addOption(subdivideOption);
+	const QCommandLineOption frameStatsOption("frame-stats", "Show frame time percentiles below the FPS counter.");
+	parser.addOption(frameStatsOption);
+	const QCommandLineOption traceOption("trace", "Write a Chrome trace-event JSON file of the session on exit.", "file");
+	parser.addOption(traceOption);
+	const QCommandLineOption headlessOption("headless", "Render offscreen without a window and print frame timings as JSON.");
+	parser.addOption(headlessOption);
+	const QCommandLineOption sizeOption("size", "Framebuffer size of a headless run.", "WxH", "1280x720");
+	parser.addOption(sizeOption);
+	const QCommandLineOption framesOption("frames", "Number of frames of a headless run.", "count", "60");
+	parser.addOption(framesOption);
+	const QCommandLineOption outputOption("output", "Save the last headless frame to an image file.", "file");
+	parser.addOption(outputOption);
+	const QCommandLineOption precisionOption("shader-precision", "GPU field shader: auto, float or df64. A headless run with compare times float against df64.", "precision", "auto");
+	parser.addOption(precisionOption);
+	const QCommandLineOption zoomOption("zoom", "Initial zoom, a headless run renders at this depth.", "zoom", "0.4");
+	parser.addOption(zoomOption);
+	const QCommandLineOption centreOption("centre", "Initial plane position of the view centre.", "x,y", "0,0");
+	parser.addOption(centreOption);
+	parser.process(app);
+
+	const auto tracePath = parser.value(traceOption);
+	if (!tracePath.isEmpty()) {
+		fgl::setTraceThreadName("gui");
+		fgl::startTrace();
+	}
+	const auto finishTrace = [&tracePath] {
+		if (!tracePath.isEmpty() && !fgl::stopTrace(tracePath.toStdString())) {
+			std::fprintf(stderr, "Could not write %s\n", qPrintable(tracePath));
+		}
+	};
+
 	QSurfaceFormat format;
 	format.setSamples(g_sampels);
 	format.setVersion(g_gl_major_version, g_gl_minor_version);
@@ -23,6 +191,48 @@ int main(int argc, char ** argv) {
 
 	FractalWindow window;
 	window.setFormat(format);
+	window.setThreadedRendering(!parser.isSet(guiThreadOption));
+	window.setZoomReprojection(!parser.isSet(noReprojectionOption));
+	window.setProgressiveRefinement(!parser.isSet(noProgressiveOption));
+	// Headless runs time frames at the requested size
+	window.setFrameBudget(parser.isSet(headlessOption) ? 0.0 : parser.value(frameBudgetOption).toDouble());
+	window.setPeriodicityTolerance(parser.value(periodicityOption).toDouble());
+	window.setSymmetry(!parser.isSet(noSymmetryOption));
+	window.setSubdivide(parser.isSet(subdivideOption));
+	if (parser.isSet(cpuOption)) {
+		window.setBackend(FractalWindow::Backend::Cpu);
+	}
+	const auto precision = parser.value(precisionOption);
+	if (precision == "float") {
+		window.setShaderPrecision(FractalWindow::ShaderPrecision::Float);
+	} else if (precision == "df64") {
+		window.setShaderPrecision(FractalWindow::ShaderPrecision::Df64);
+	} else if (precision != "auto" && precision != "compare") {
+		std::fprintf(stderr, "Invalid --shader-precision\n");
+		return 1;
+	}
+	const auto centre = parser.value(centreOption).split(',');
+	window.setZoom(parser.value(zoomOption).toDouble());
+	window.setCentre(centre.value(0).toDouble(), centre.value(1).toDouble());
+	fgl::TilePoolOptions poolOptions;
+	poolOptions.threadCount = parser.value(threadsOption).toUInt();
+	poolOptions.pinThreads = parser.isSet(pinOption);
+	window.setTilePoolOptions(poolOptions);
+
+	if (parser.isSet(headlessOption)) {
+		const auto size = parser.value(sizeOption).split('x');
+		const auto width = size.value(0).toInt();
+		const auto height = size.value(1).toInt();
+		const auto frames = parser.value(framesOption).toInt();
+		if (width <= 0 || height <= 0 || frames <= 0) {
+			std::fprintf(stderr, "Invalid --size or --frames\n");
+			return 1;
+		}
+		const auto result = precision == "compare" ? comparePrecision(window, QSize(width, height), frames, parser.value(outputOption))
+												   : runHeadless(window, QSize(width, height), frames, parser.value(outputOption));
+		finishTrace();
+		return result;
+	}
 
 	QWidget * container = QWidget::createWindowContainer(&window);
 	container->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -31,24 +241,39 @@ int main(int argc, char ** argv) {
 	FractalWidget * widget = new FractalWidget(nullptr);
 
 	window.setFpsCounter(widget->fpsLabelValue_);
+	if (parser.isSet(frameStatsOption)) {
+		widget->frameStatsLabel_->show();
+		widget->frameStatsLabelValue_->show();
+		window.setFrameStatsLabel(widget->frameStatsLabelValue_);
+	}
 
 	layout->addWidget(container);
 	layout->addWidget(widget, 0, Qt::Alignment(Qt::AlignBottom));
+	// Every handler is a trace zone, so hitches can be tied to the input that caused them
 	QObject::connect(widget->iterationsEdit, &QSlider::valueChanged, &window,
-					 &FractalWindow::setIterations);
+					 [&window](int value) { const fgl::TraceZone zone{"iterations slider"}; window.setIterations(value); });
 	QObject::connect(widget->param1Edit, &QSlider::valueChanged, &window,
-					 &FractalWindow::setParam1);
+					 [&window](int value) { const fgl::TraceZone zone{"param1 slider"}; window.setParam1(static_cast<float>(value)); });
 	QObject::connect(widget->param2Edit, &QSlider::valueChanged, &window,
-					 &FractalWindow::setParam2);				 
+					 [&window](int value) { const fgl::TraceZone zone{"param2 slider"}; window.setParam2(static_cast<float>(value)); });
 	QObject::connect(widget->param3Edit, &QSlider::valueChanged, &window,
-					 &FractalWindow::setParam3);
+					 [&window](int value) { const fgl::TraceZone zone{"param3 slider"}; window.setParam3(static_cast<float>(value)); });
+	QObject::connect(widget->paletteEdit, QOverload<int>::of(&QComboBox::currentIndexChanged), &window,
+					 [&window](int index) { const fgl::TraceZone zone{"palette"}; window.setPalette(static_cast<fgl::Palette>(index)); });
+	QObject::connect(widget->contrastEdit, &QSlider::valueChanged, &window,
+					 [&window](int value) { const fgl::TraceZone zone{"contrast slider"}; window.setContrast(static_cast<float>(value) / 100.0f); });
+	QObject::connect(widget->cycleEdit, &QSlider::valueChanged, &window,
+					 [&window](int value) { const fgl::TraceZone zone{"cycle slider"}; window.setColourCycle(static_cast<float>(value) / 100.0f); });
 
 	auto window1 = new QWidget;
 	window1->resize(640, 480);
 	window1->setLayout(layout);
 	window1->show();
 
-	window.setAnimated(true);
+	window.setUpdateMode(parser.isSet(continuousOption) ? fgl::GLWindow::UpdateMode::Continuous
+														: fgl::GLWindow::UpdateMode::OnDemand);
 
-	return app.exec();
+	const auto result = app.exec();
+	finishTrace();
+	return result;
 }
\ No newline at end of file
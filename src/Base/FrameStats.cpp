@@ -0,0 +1,165 @@
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace fgl
+{
+
+namespace
+{
+
+double percentile(const std::vector<double> & sorted, const double fraction)
+{
+	// Nearest rank, so p99 of a short run is its slowest frame.
+	const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+	return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+}// namespace
+
+void TimingSeries::record(const float ms)
+{
+	const auto index = head_.load(std::memory_order_relaxed);
+	values_[index % Capacity].store(ms, std::memory_order_relaxed);
+	head_.store(index + 1, std::memory_order_release);
+}
+
+std::vector<double> TimingSeries::values() const
+{
+	const auto head = head_.load(std::memory_order_acquire);
+	const auto first = std::max(resetAt_.load(std::memory_order_relaxed), head > Capacity ? head - Capacity : 0);
+
+	std::vector<double> result;
+	result.reserve(static_cast<std::size_t>(head - first));
+	for (auto index = first; index < head; ++index)
+	{
+		result.push_back(values_[index % Capacity].load(std::memory_order_relaxed));
+	}
+
+	// Drop the oldest values if the writer lapped them while copying. The
+	// writer may be storing index headAfter already, over headAfter - Capacity.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const auto headAfter = head_.load(std::memory_order_relaxed);
+	if (headAfter + 1 > first + Capacity)
+	{
+		const auto overwritten = std::min<std::uint64_t>(headAfter + 1 - first - Capacity, result.size());
+		result.erase(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(overwritten));
+	}
+	return result;
+}
+
+float TimingSeries::latest() const
+{
+	const auto head = head_.load(std::memory_order_acquire);
+	if (head <= resetAt_.load(std::memory_order_relaxed))
+	{
+		return 0.0f;
+	}
+	return values_[(head - 1) % Capacity].load(std::memory_order_relaxed);
+}
+
+FrameSummary TimingSeries::summary() const
+{
+	auto sorted = values();
+	FrameSummary result;
+	if (sorted.empty())
+	{
+		return result;
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+	result.count = sorted.size();
+	result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+	result.p50 = percentile(sorted, 0.50);
+	result.p95 = percentile(sorted, 0.95);
+	result.p99 = percentile(sorted, 0.99);
+	result.max = sorted.back();
+	return result;
+}
+
+std::vector<std::size_t> TimingSeries::histogram(const double bucketMs, const std::size_t bucketCount) const
+{
+	std::vector<std::size_t> buckets(bucketCount, 0);
+	if (bucketCount == 0 || bucketMs <= 0.0)
+	{
+		return buckets;
+	}
+
+	for (const auto value : values())
+	{
+		const auto bucket = static_cast<std::size_t>(std::max(0.0, value / bucketMs));
+		++buckets[std::min(bucket, bucketCount - 1)];
+	}
+	return buckets;
+}
+
+void TimingSeries::reset() { resetAt_.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed); }
+
+void FrameStats::record(const FrameSample & sample)
+{
+	cpu_.record(sample.cpuMs);
+	swap_.record(sample.swapMs);
+	// The first frame has no predecessor.
+	if (sample.intervalMs > 0.0f)
+	{
+		interval_.record(sample.intervalMs);
+	}
+}
+
+const TimingSeries & FrameStats::series(const FrameMetric metric) const
+{
+	switch (metric)
+	{
+		case FrameMetric::Swap:
+			return swap_;
+		case FrameMetric::Interval:
+			return interval_;
+		case FrameMetric::Cpu:
+		default:
+			return cpu_;
+	}
+}
+
+std::size_t FrameStats::gpuPass(const char * name)
+{
+	const auto count = gpuPassCount_.load(std::memory_order_relaxed);
+	for (std::size_t pass = 0; pass < count; ++pass)
+	{
+		if (gpuNames_[pass] == name)
+		{
+			return pass;
+		}
+	}
+	if (count == MaxGpuPasses)
+	{
+		return MaxGpuPasses;
+	}
+
+	// Readers only look at names below the published count.
+	gpuNames_[count] = name;
+	gpuPassCount_.store(count + 1, std::memory_order_release);
+	return count;
+}
+
+void FrameStats::recordGpu(const std::size_t pass, const float ms)
+{
+	if (pass < MaxGpuPasses)
+	{
+		gpuSeries_[pass].record(ms);
+	}
+}
+
+void FrameStats::reset()
+{
+	cpu_.reset();
+	swap_.reset();
+	interval_.reset();
+	for (auto & series : gpuSeries_)
+	{
+		series.reset();
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fgl
+{
+
+// Timings of one frame in milliseconds.
+struct FrameSample
+{
+	// render() on the CPU side.
+	float cpuMs = 0.0f;
+	// swapBuffers(), includes waiting for vsync.
+	float swapMs = 0.0f;
+	// Since the start of the previous frame, 0 for the first one. In
+	// on-demand mode this includes idle time, measure pacing in continuous.
+	float intervalMs = 0.0f;
+};
+
+enum class FrameMetric
+{
+	Cpu,
+	Swap,
+	Interval,
+};
+
+struct FrameSummary
+{
+	std::size_t count = 0;
+	double mean = 0.0;
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+};
+
+// The last Capacity values of one timing. record() is wait-free and meant
+// for a single writer, everything else may run on any thread at any time
+// and never blocks the writer.
+class TimingSeries
+{
+public:
+	static constexpr std::size_t Capacity = 1024;
+
+public:
+	void record(float ms);
+
+	// Oldest first, at most Capacity values recorded since the last reset.
+	std::vector<double> values() const;
+
+	// Values ever recorded, tells whether a new one came in.
+	std::uint64_t recorded() const { return head_.load(std::memory_order_acquire); }
+	// The value recorded last, 0 if there was none since the last reset.
+	float latest() const;
+
+	FrameSummary summary() const;
+
+	// Counts of values per bucketMs wide bucket, the last bucket also
+	// counts everything slower.
+	std::vector<std::size_t> histogram(double bucketMs, std::size_t bucketCount) const;
+
+	// Forgets all values recorded so far.
+	void reset();
+
+private:
+	std::array<std::atomic<float>, Capacity> values_{};
+	// Number of values ever recorded, slot of value i is i % Capacity.
+	std::atomic<std::uint64_t> head_{0};
+	std::atomic<std::uint64_t> resetAt_{0};
+};
+
+// CPU side timings of every frame plus GPU timings of named passes, written
+// by the rendering thread and readable from any other.
+class FrameStats
+{
+public:
+	static constexpr std::size_t MaxGpuPasses = 8;
+
+public:
+	void record(const FrameSample & sample);
+
+	const TimingSeries & series(FrameMetric metric) const;
+	FrameSummary summary(const FrameMetric metric) const { return series(metric).summary(); }
+	std::vector<std::size_t> histogram(const FrameMetric metric, const double bucketMs, const std::size_t bucketCount) const
+	{
+		return series(metric).histogram(bucketMs, bucketCount);
+	}
+
+	// Index of the GPU pass with that name, registering it on first use.
+	// Writer thread only, returns MaxGpuPasses once all are taken.
+	std::size_t gpuPass(const char * name);
+	void recordGpu(std::size_t pass, float ms);
+
+	// Passes registered so far, their names and series never change.
+	std::size_t gpuPassCount() const { return gpuPassCount_.load(std::memory_order_acquire); }
+	const std::string & gpuPassName(const std::size_t pass) const { return gpuNames_[pass]; }
+	const TimingSeries & gpuSeries(const std::size_t pass) const { return gpuSeries_[pass]; }
+
+	void reset();
+
+private:
+	TimingSeries cpu_;
+	TimingSeries swap_;
+	TimingSeries interval_;
+
+	std::array<std::string, MaxGpuPasses> gpuNames_;
+	std::array<TimingSeries, MaxGpuPasses> gpuSeries_;
+	std::atomic<std::size_t> gpuPassCount_{0};
+};
+
+}// namespace fgl
@@ -1,10 +1,82 @@
 #include "GLWindow.hpp"
 
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLFramebufferObject>
 #include <QPainter>
+#include <QThread>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 
 namespace fgl
 {
 
+// Owns the GL context while threaded rendering is on. Frame requests from
+// the GUI thread are coalesced, so a slow frame never queues up more work.
+class GLWindow::RenderThread final : public QThread
+{
+public:
+	explicit RenderThread(GLWindow & window)
+		: window_{window}
+	{
+	}
+
+	void requestFrame()
+	{
+		const std::lock_guard<std::mutex> lock{mutex_};
+		frameRequested_ = true;
+		wake_.notify_one();
+	}
+
+	void stop()
+	{
+		{
+			const std::lock_guard<std::mutex> lock{mutex_};
+			stopping_ = true;
+			wake_.notify_one();
+		}
+		wait();
+	}
+
+protected:
+	void run() override
+	{
+		setTraceThreadName("render");
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock{mutex_};
+				wake_.wait(lock, [this] { return frameRequested_ || stopping_; });
+				if (stopping_)
+				{
+					break;
+				}
+				frameRequested_ = false;
+			}
+
+			window_.renderFrame();
+
+			// Keep going while continuous, swapBuffers() throttles to vsync.
+			if (window_.updateMode() == UpdateMode::Continuous)
+			{
+				const std::lock_guard<std::mutex> lock{mutex_};
+				frameRequested_ = true;
+			}
+		}
+		window_.releaseContext();
+	}
+
+private:
+	GLWindow & window_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	bool frameRequested_ = false;
+	bool stopping_ = false;
+};
+
 GLWindow::GLWindow(QWindow * parent)
 	: QWindow{parent}
 {
@@ -12,6 +84,8 @@ GLWindow::GLWindow(QWindow * parent)
 	setSurfaceType(QWindow::OpenGLSurface);
 }
 
+GLWindow::~GLWindow() { shutdown(); }
+
 void GLWindow::init() {}
 
 void GLWindow::render()
@@ -19,16 +93,15 @@ void GLWindow::render()
 	// Lazy init render device.
 	if (!device_)
 	{
-		device_ = std::make_unique<QOpenGLPaintDevice>(size());
+		device_ = std::make_unique<QOpenGLPaintDevice>(framebufferSize());
 	}
 
 	// Clear all buffers.
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
 	// Init sizes.
-	const auto pixelRatio = devicePixelRatio();
-	device_->setSize(size() * pixelRatio);
-	device_->setDevicePixelRatio(pixelRatio);
+	device_->setSize(framebufferSize());
+	device_->setDevicePixelRatio(framebufferPixelRatio());
 
 	// Paint now.
 	const QPainter painter{device_.get()};
@@ -39,56 +112,299 @@ void GLWindow::render(const QPainter &) {}
 
 void GLWindow::destroy() {}
 
+void GLWindow::invalidate() {}
+
+GLWindow::GpuScope::GpuScope(GLWindow & window, const char * name)
+	: zone_{name}
+	, query_{window.beginGpuScope(name)}
+{
+}
+
+GLWindow::GpuScope::~GpuScope()
+{
+	if (query_)
+	{
+		query_->end();
+	}
+}
+
+QOpenGLTimerQuery * GLWindow::beginGpuScope(const char * name)
+{
+	if (!gpuTimersSupported_)
+	{
+		return nullptr;
+	}
+
+	const auto pass = frameStats_.gpuPass(name);
+	auto timer = std::find_if(gpuTimers_.begin(), gpuTimers_.end(), [pass](const GpuTimer & timer) { return timer.pass == pass; });
+	if (timer == gpuTimers_.end())
+	{
+		GpuTimer created;
+		created.pass = pass;
+		for (auto & query : created.queries)
+		{
+			query = std::make_unique<QOpenGLTimerQuery>();
+			// Needs GL 3.3 or ARB_timer_query.
+			if (!query->create())
+			{
+				gpuTimersSupported_ = false;
+				return nullptr;
+			}
+		}
+		timer = gpuTimers_.insert(gpuTimers_.end(), std::move(created));
+	}
+
+	// Collect what this query measured two frames ago, skip it if the GPU
+	// is still behind rather than wait.
+	const auto slot = gpuFrame_ % timer->queries.size();
+	auto & query = *timer->queries[slot];
+	if (timer->issued[slot] && query.isResultAvailable())
+	{
+		frameStats_.recordGpu(timer->pass, static_cast<float>(static_cast<double>(query.waitForResult()) * 1e-6));
+	}
+	timer->issued[slot] = true;
+	query.begin();
+	return &query;
+}
+
+void GLWindow::endGpuFrame() { ++gpuFrame_; }
+
 void GLWindow::renderLater()
 {
 	// Post message to request window surface redraw.
 	requestUpdate();
 }
 
-void GLWindow::setAnimated(const bool animating) { animating_ = animating; }
+void GLWindow::setAnimated(const bool animating) { setUpdateMode(animating ? UpdateMode::Continuous : UpdateMode::OnDemand); }
+
+void GLWindow::setUpdateMode(const UpdateMode mode)
+{
+	updateMode_ = mode;
+	markDirty();
+}
+
+void GLWindow::markDirty()
+{
+	dirty_ = true;
+	if (QThread::currentThread() == thread())
+	{
+		renderLater();
+	}
+	else
+	{
+		QMetaObject::invokeMethod(this, &GLWindow::renderLater, Qt::QueuedConnection);
+	}
+}
+
+void GLWindow::setThreadedRendering(const bool threaded)
+{
+	Q_ASSERT(!context_);
+	threaded_ = threaded;
+}
+
+void GLWindow::shutdown()
+{
+	if (renderThread_)
+	{
+		// The thread calls destroy() before it finishes.
+		renderThread_->stop();
+		renderThread_.reset();
+	}
+	else if (context_ && !needsInitialize_ && context_->makeCurrent(this))
+	{
+		destroy();
+		gpuTimers_.clear();
+		needsInitialize_ = true;
+		context_->doneCurrent();
+	}
+}
+
+QSize GLWindow::framebufferSize() const { return QSize{framebufferWidth_.load(), framebufferHeight_.load()}; }
+
+GLuint GLWindow::targetFramebuffer() const
+{
+	return offscreenFramebuffer_ != 0 ? offscreenFramebuffer_ : context_->defaultFramebufferObject();
+}
+
+GLWindow::OffscreenRun GLWindow::renderOffscreen(const QSize & size, const int frames, const bool fullFrames)
+{
+	// Offscreen runs own the context on the calling thread.
+	Q_ASSERT(!renderThread_);
+	OffscreenRun run;
+
+	QOffscreenSurface surface;
+	surface.setFormat(requestedFormat());
+	surface.create();
+	if (!context_)
+	{
+		context_ = std::make_unique<QOpenGLContext>();
+		context_->setFormat(requestedFormat());
+		if (!context_->create())
+		{
+			return run;
+		}
+	}
+	if (!context_->makeCurrent(&surface))
+	{
+		return run;
+	}
+
+	run.renderer = QString::fromLatin1(reinterpret_cast<const char *>(context_->functions()->glGetString(GL_RENDERER)));
+	framebufferWidth_ = size.width();
+	framebufferHeight_ = size.height();
+	pixelRatio_ = 1.0;
+	if (needsInitialize_)
+	{
+		initializeOpenGLFunctions();
+		init();
+		needsInitialize_ = false;
+	}
+
+	QOpenGLFramebufferObject target{size, QOpenGLFramebufferObject::CombinedDepthStencil};
+	offscreenFramebuffer_ = target.handle();
+	run.frameSeconds.reserve(static_cast<size_t>(std::max(frames, 0)));
+	QElapsedTimer timer;
+	for (auto frame = 0; frame < frames; ++frame)
+	{
+		if (fullFrames)
+		{
+			invalidate();
+		}
+		target.bind();
+		timer.start();
+		render();
+		// Without it only the time to queue the commands would be measured.
+		glFinish();
+		run.frameSeconds.push_back(static_cast<double>(timer.nsecsElapsed()) * 1e-9);
+		endGpuFrame();
+	}
+	run.image = target.toImage();
+	offscreenFramebuffer_ = 0;
+
+	destroy();
+	gpuTimers_.clear();
+	needsInitialize_ = true;
+	context_->doneCurrent();
+	return run;
+}
 
 void GLWindow::renderNow()
 {
+	const TraceZone zone{"renderNow"};
+
 	// If not exposed yet then skip render.
 	if (!isExposed())
 	{
 		return;
 	}
 
-	auto needsInitialize = false;
+	// Nothing changed since the last frame.
+	const auto dirty = dirty_.exchange(false);
+	if (!dirty && updateMode() == UpdateMode::OnDemand)
+	{
+		return;
+	}
+
+	updateFramebufferSize();
 
 	// Lazy init gl context.
 	if (!context_)
 	{
-		context_ = std::make_unique<QOpenGLContext>(this);
+		context_ = std::make_unique<QOpenGLContext>();
 		context_->setFormat(requestedFormat());
 		context_->create();
 
-		needsInitialize = true;
+		// Some drivers can only render from the GUI thread.
+		threaded_ = threaded_ && QOpenGLContext::supportsThreadedOpenGL();
+		if (threaded_)
+		{
+			renderThread_ = std::make_unique<RenderThread>(*this);
+			context_->moveToThread(renderThread_.get());
+			renderThread_->start();
+		}
+	}
+
+	if (renderThread_)
+	{
+		renderThread_->requestFrame();
+		return;
+	}
+
+	renderFrame();
+
+	// Post message to redraw later if continuous.
+	if (updateMode() == UpdateMode::Continuous)
+	{
+		renderLater();
 	}
+}
 
+void GLWindow::updateFramebufferSize()
+{
+	const auto pixelRatio = devicePixelRatio();
+	const auto deviceSize = size() * pixelRatio;
+	framebufferWidth_ = deviceSize.width();
+	framebufferHeight_ = deviceSize.height();
+	pixelRatio_ = pixelRatio;
+}
+
+void GLWindow::renderFrame()
+{
 	const auto contextBindSuccess = context_->makeCurrent(this);
 	if (!contextBindSuccess)
 	{
 		return;
 	}
 
-	if (needsInitialize)
+	if (needsInitialize_)
 	{
 		initializeOpenGLFunctions();
 		init();
+		needsInitialize_ = false;
 	}
 
+	using Milliseconds = std::chrono::duration<float, std::milli>;
+	const auto frameStart = std::chrono::steady_clock::now();
+	FrameSample sample;
+	if (hasLastFrame_)
+	{
+		sample.intervalMs = Milliseconds{frameStart - lastFrameStart_}.count();
+	}
+	lastFrameStart_ = frameStart;
+	hasLastFrame_ = true;
+
 	// Render now then swap buffers.
-	render();
+	{
+		const TraceZone zone{"render"};
+		render();
+	}
+	const auto swapStart = std::chrono::steady_clock::now();
+	sample.cpuMs = Milliseconds{swapStart - frameStart}.count();
 
-	context_->swapBuffers(this);
+	{
+		const TraceZone zone{"swapBuffers"};
+		context_->swapBuffers(this);
+	}
+	endGpuFrame();
+	sample.swapMs = Milliseconds{std::chrono::steady_clock::now() - swapStart}.count();
+	frameStats_.record(sample);
+	traceCounter("frame cpu ms", sample.cpuMs);
+	traceCounter("swap ms", sample.swapMs);
+}
 
-	// Post message to redraw later if animating.
-	if (animating_)
+void GLWindow::releaseContext()
+{
+	if (!needsInitialize_ && context_->makeCurrent(this))
 	{
-		renderLater();
+		destroy();
+		gpuTimers_.clear();
+		needsInitialize_ = true;
 	}
+	context_->doneCurrent();
+	device_.reset();
+
+	// Hand the context back so the GUI thread can delete it.
+	context_->moveToThread(QGuiApplication::instance()->thread());
 }
 
 bool GLWindow::event(QEvent * event)
@@ -101,14 +417,8 @@ bool GLWindow::event(QEvent * event)
 			renderNow();
 			return true;
 		case QEvent::Close:
-		{
-			const auto contextBindSuccess = context_->makeCurrent(this);
-			if (contextBindSuccess)
-			{
-				destroy();
-			}
-			return QWindow::event(event);;
-		}
+			shutdown();
+			return QWindow::event(event);
 		default:
 			return QWindow::event(event);
 	}
@@ -118,8 +428,16 @@ void GLWindow::exposeEvent(QExposeEvent *)
 {
 	if (isExposed())
 	{
+		dirty_ = true;
 		renderNow();
 	}
 }
 
+void GLWindow::resizeEvent(QResizeEvent * event)
+{
+	updateFramebufferSize();
+	markDirty();
+	QWindow::resizeEvent(event);
+}
+
 }// namespace fgl
@@ -1,15 +1,26 @@
 #pragma once
 
+#include <Base/FrameStats.hpp>
+#include <Core/Trace.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <vector>
 
+#include <QImage>
+#include <QSize>
 #include <QWindow>
 
 #include <QOpenGLContext>
 #include <QOpenGLFunctions>
 #include <QOpenGLPaintDevice>
+#include <QOpenGLTimerQuery>
 
 class QEvent;
 class QExposeEvent;
+class QResizeEvent;
 
 namespace fgl
 {
@@ -20,7 +31,7 @@ class GLWindow : public QWindow
 	Q_OBJECT
 public:
 	explicit GLWindow(QWindow * parent = nullptr);
-	virtual ~GLWindow() = default;
+	virtual ~GLWindow();
 
 public:
 	virtual void init();
@@ -30,21 +41,131 @@ public:
 
 	virtual void destroy();
 
+	// Drops anything cached from earlier frames so the next render() starts
+	// from scratch, used to time full frames.
+	virtual void invalidate();
+
 public:
+	enum class UpdateMode
+	{
+		// Render again right after every frame, for benchmarking.
+		Continuous,
+		// Render only after markDirty(), an expose or a resize.
+		OnDemand,
+	};
+
+	void setUpdateMode(UpdateMode mode);
+	UpdateMode updateMode() const { return updateMode_.load(); }
 	void setAnimated(bool animating = false);
 
+	// Runs init(), render() and destroy() on a dedicated thread that owns
+	// the GL context. Must be called before the window is exposed.
+	void setThreadedRendering(bool threaded);
+	bool isThreadedRendering() const { return threaded_; }
+
+	// Stops the render thread and releases GL resources, derived classes
+	// call it from their destructor so destroy() still sees their members.
+	void shutdown();
+
+	// Size of the default framebuffer in device pixels and the pixel ratio,
+	// safe to call from the render thread.
+	QSize framebufferSize() const;
+	qreal framebufferPixelRatio() const { return pixelRatio_.load(); }
+
+	// CPU, swap and interval times of the recent frames, readable from any
+	// thread while rendering goes on.
+	const FrameStats & frameStats() const { return frameStats_; }
+	void resetFrameStats() { frameStats_.reset(); }
+
+	// Times the GL commands issued during its lifetime with GL_TIME_ELAPSED
+	// and records them as a GPU pass of frameStats(), the CPU side shows up
+	// as a zone of the same name in traces. Each query is read
+	// back two frames later, so timing never stalls the pipeline. Scopes must
+	// not nest and a name should be used once per frame.
+	class GpuScope
+	{
+	public:
+		GpuScope(GLWindow & window, const char * name);
+		~GpuScope();
+
+		GpuScope(const GpuScope &) = delete;
+		GpuScope & operator=(const GpuScope &) = delete;
+
+	private:
+		TraceZone zone_;
+		QOpenGLTimerQuery * query_ = nullptr;
+	};
+
+	// Framebuffer render() has to draw its final image into, either the
+	// window's default one or the target of an offscreen run.
+	GLuint targetFramebuffer() const;
+
+	struct OffscreenRun
+	{
+		// Wall time of each render() including glFinish().
+		std::vector<double> frameSeconds;
+		// Contents of the target after the last frame.
+		QImage image;
+		// GL_RENDERER of the context, tells hardware and Mesa runs apart.
+		QString renderer;
+	};
+
+	// Renders frames into an FBO of the given size through init(), render()
+	// and destroy() on a QOffscreenSurface, the window is never shown. Works
+	// without a display with QT_QPA_PLATFORM=offscreen. With fullFrames set
+	// invalidate() runs before every frame. Returns no frames on failure.
+	OffscreenRun renderOffscreen(const QSize & size, int frames, bool fullFrames = true);
+
 public slots:
 	void renderNow();
 	void renderLater();
+	// Schedules a frame because something visible changed, thread-safe.
+	void markDirty();
 
 protected:
 	bool event(QEvent * event) override;
 	void exposeEvent(QExposeEvent * event) override;
+	void resizeEvent(QResizeEvent * event) override;
+
+private:
+	class RenderThread;
+
+	void updateFramebufferSize();
+	void renderFrame();
+	void releaseContext();
+	QOpenGLTimerQuery * beginGpuScope(const char * name);
+	void endGpuFrame();
+
+	struct GpuTimer
+	{
+		std::size_t pass = 0;
+		std::array<std::unique_ptr<QOpenGLTimerQuery>, 2> queries;
+		std::array<bool, 2> issued{false, false};
+	};
 
 private:
-	bool animating_ = false;
+	std::atomic<UpdateMode> updateMode_{UpdateMode::OnDemand};
+	std::atomic<bool> dirty_{true};
+	bool threaded_ = false;
+	bool needsInitialize_ = true;
 	std::unique_ptr<QOpenGLContext> context_ = nullptr;
 	std::unique_ptr<QOpenGLPaintDevice> device_ = nullptr;
+	std::unique_ptr<RenderThread> renderThread_ = nullptr;
+	GLuint offscreenFramebuffer_ = 0;
+
+	FrameStats frameStats_;
+	// Start of the previous frame, only touched by the rendering thread.
+	std::chrono::steady_clock::time_point lastFrameStart_;
+	bool hasLastFrame_ = false;
+
+	// Render thread only, dropped together with the other GL resources.
+	std::vector<GpuTimer> gpuTimers_;
+	std::size_t gpuFrame_ = 0;
+	bool gpuTimersSupported_ = true;
+
+	std::atomic<int> framebufferWidth_{0};
+	std::atomic<int> framebufferHeight_{0};
+	std::atomic<qreal> pixelRatio_{1.0};
 };
 
 }// namespace fgl
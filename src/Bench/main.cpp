@@ -0,0 +1,607 @@
+// Throughput of the CPU Julia kernels on fixed reference viewports.
+// Prints JSON so runs of different builds can be diffed.
+//
+// Usage: fractal-bench [--size WxH] [--repeats N] [--max-threads N] [--periodicity T]
+//
+// Every viewport is also rendered with Mariani-Silver subdivision on all
+// workers, its speedup is relative to the direct render on as many workers,
+// and with perturbation on the calling thread. Double-double and quad-double
+// run with the best kernel, their slowdown is the cost per iteration
+// relative to its double precision. Both extended precisions and
+// perturbation also render zooms beyond double around a repelling fixed
+// point of the boundary set.
+//
+// Seconds and megapixels per second are timed with the periodicity
+// tolerance. Iterations per second are timed without, cycling pixels would
+// count iterations never performed otherwise, and periodicity_speedup is the
+// ratio of both runs.
+//
+// The limb products of FixedPoint are timed against schoolbook ones from
+// DeepReal's size up to sizes that take the Karatsuba path, and have to
+// match them exactly.
+
+#include <Core/DeepZoom.hpp>
+#include <Core/FixedPoint.hpp>
+#include <Core/JuliaKernel.hpp>
+#include <Core/JuliaRenderer.hpp>
+#include <Core/TilePool.hpp>
+#include <Core/Viewport.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Settings
+{
+	int width = 512;
+	int height = 512;
+	// Every measurement is the fastest of this many runs.
+	int repeats = 5;
+	unsigned maxThreads = 0;
+	// Periodicity checking tolerance in pixels, 0 iterates every pixel to the cap.
+	double periodicity = fgl::RenderOptions{}.periodicityTolerance;
+};
+
+struct Reference
+{
+	const char * name;
+	fgl::Viewport viewport;
+};
+
+struct Measurement
+{
+	double seconds = 0.0;
+	std::uint64_t iterations = 0;
+	// Time of the run that performed iterations, without periodicity checking.
+	double iterationSeconds = 0.0;
+};
+
+const std::vector<int> g_iteration_caps = {100, 1000};
+const std::vector<double> g_deep_zooms = {1e30, 1e100, 1e250};
+
+struct ExtendedZoom
+{
+	double zoom;
+	// Cheapest precision that still resolves the pixels.
+	fgl::Precision precision;
+};
+
+const std::vector<ExtendedZoom> g_extended_zooms = {
+	{1e20, fgl::Precision::DoubleDouble},
+	{1e40, fgl::Precision::QuadDouble},
+};
+// Pixels near the fixed point need a few hundred iterations per 1e100.
+constexpr auto g_deep_iterations = 3000;
+// Limb products per timed run of a bignum result.
+constexpr auto g_limb_products = 1000;
+
+fgl::Viewport makeViewport(const double zoom, const double shiftX, const double shiftY, const float param2, const float param3)
+{
+	fgl::Viewport viewport;
+	viewport.zoom = zoom;
+	viewport.shiftX = shiftX;
+	viewport.shiftY = shiftY;
+	viewport.param1 = 0.0f;
+	viewport.param2 = param2;
+	viewport.param3 = param3;
+	return viewport;
+}
+
+// From every pixel reaching the cap to every pixel escaping at once.
+std::vector<Reference> references()
+{
+	return {
+		// c = 0 fills the unit disk, the view stays inside it
+		{"interior", makeViewport(4.0, 0.0, 0.0, 0.0f, 0.0f)},
+		// Same set, but the view covers x in [2, 4]
+		{"exterior", makeViewport(1.0, 3.0, 0.0, 0.0f, 0.0f)},
+		// c = -0.745 + 0.113i has a long spiralling boundary
+		{"boundary", makeViewport(0.6, 0.0, 0.0, -745.0f, 113.0f)},
+		// What demo-app shows on start
+		{"default", fgl::Viewport{}},
+	};
+}
+
+bool parseSize(const char * text, Settings & settings)
+{
+	return std::sscanf(text, "%dx%d", &settings.width, &settings.height) == 2 && settings.width > 0 && settings.height > 0;
+}
+
+bool parseArguments(const int argc, char ** argv, Settings & settings)
+{
+	for (auto i = 1; i < argc; ++i)
+	{
+		const auto hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--size") == 0 && hasValue)
+		{
+			if (!parseSize(argv[++i], settings))
+			{
+				return false;
+			}
+		}
+		else if (std::strcmp(argv[i], "--repeats") == 0 && hasValue)
+		{
+			settings.repeats = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--max-threads") == 0 && hasValue)
+		{
+			settings.maxThreads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+		}
+		else if (std::strcmp(argv[i], "--periodicity") == 0 && hasValue)
+		{
+			settings.periodicity = std::max(0.0, std::atof(argv[++i]));
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Fastest of repeats calls of render in seconds.
+template <typename Render>
+double fastest(const int repeats, const Render & render)
+{
+	auto best = std::numeric_limits<double>::max();
+	for (auto repeat = 0; repeat < repeats; ++repeat)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		render();
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+template <typename View>
+Measurement measureJulia(const View & viewport, const fgl::Viewport & view, const fgl::RenderOptions & options, const int repeats)
+{
+	std::vector<std::uint32_t> counts(static_cast<std::size_t>(view.width) * static_cast<std::size_t>(view.height));
+
+	Measurement best;
+	best.seconds = fastest(repeats, [&] { fgl::renderJulia(viewport, counts, options); });
+	best.iterationSeconds = best.seconds;
+	// A cycling pixel counts the cap without iterating to it, the throughput
+	// is timed without periodicity checking.
+	if (options.periodicityTolerance > 0.0)
+	{
+		auto exhaustive = options;
+		exhaustive.periodicityTolerance = 0.0;
+		best.iterationSeconds = fastest(repeats, [&] { fgl::renderJulia(viewport, counts, exhaustive); });
+	}
+	// Every count is the number of iterations performed for that pixel now.
+	best.iterations = std::accumulate(counts.begin(), counts.end(), std::uint64_t{0});
+	return best;
+}
+
+Measurement measure(const fgl::Viewport & viewport, const fgl::RenderOptions & options, const int repeats)
+{
+	return measureJulia(viewport, viewport, options, repeats);
+}
+
+Measurement measureExtended(const fgl::DeepViewport & viewport, const fgl::RenderOptions & options, const int repeats)
+{
+	return measureJulia(viewport, viewport.view, options, repeats);
+}
+
+Measurement measureDeep(const fgl::DeepViewport & viewport, const fgl::DeepOptions & options, const int repeats,
+						fgl::DeepStats & stats)
+{
+	const auto & view = viewport.view;
+	std::vector<std::uint32_t> counts(static_cast<std::size_t>(view.width) * static_cast<std::size_t>(view.height));
+
+	Measurement best;
+	best.seconds = fastest(repeats, [&] { stats = fgl::renderDeep(viewport, counts, options); });
+	best.iterationSeconds = best.seconds;
+	best.iterations = std::accumulate(counts.begin(), counts.end(), std::uint64_t{0});
+	return best;
+}
+
+// The repelling fixed point (1 + sqrt(1 - 4c)) / 2 lies on the Julia set, so
+// zooming into it shows detail at every depth. Newton steps with the double
+// derivative gain about 50 bits each.
+void repellingFixedPoint(const fgl::Viewport & viewport, fgl::DeepReal & x, fgl::DeepReal & y)
+{
+	const std::complex<double> constant{viewport.constantRe(), viewport.constantIm()};
+	const auto guess = (1.0 + std::sqrt(1.0 - 4.0 * constant)) / 2.0;
+	const auto inverse = 1.0 / (2.0 * guess - 1.0);
+	const fgl::DeepReal constantX{constant.real()};
+	const fgl::DeepReal constantY{constant.imag()};
+	const fgl::DeepReal inverseX{inverse.real()};
+	const fgl::DeepReal inverseY{inverse.imag()};
+
+	x = fgl::DeepReal{guess.real()};
+	y = fgl::DeepReal{guess.imag()};
+	for (auto step = 0; step < 2 * fgl::DeepReal::fractionBits / 50; ++step)
+	{
+		// f(z) = z^2 - z + c
+		const auto xy = x * y;
+		const auto fx = x.square() - y.square() - x + constantX;
+		const auto fy = xy + xy - y + constantY;
+		x -= fx * inverseX - fy * inverseY;
+		y -= fx * inverseY + fy * inverseX;
+	}
+}
+
+const char * precisionName(const fgl::Precision precision)
+{
+	switch (precision)
+	{
+		case fgl::Precision::Float:
+			return "float";
+		case fgl::Precision::Double:
+			return "double";
+		case fgl::Precision::DoubleDouble:
+			return "double-double";
+		case fgl::Precision::QuadDouble:
+			return "quad-double";
+	}
+	return "";
+}
+
+double nanosecondsPerIteration(const Measurement & measurement)
+{
+	return measurement.iterationSeconds / static_cast<double>(measurement.iterations) * 1e9;
+}
+
+// Thread counts 1, 2, 4, ... up to and including the maximum.
+std::vector<unsigned> threadCounts(const unsigned maxThreads)
+{
+	std::vector<unsigned> counts;
+	for (unsigned count = 1; count < maxThreads; count *= 2)
+	{
+		counts.push_back(count);
+	}
+	counts.push_back(maxThreads);
+	return counts;
+}
+
+class JsonWriter
+{
+public:
+	void beginResult()
+	{
+		std::printf("%s\n    {", first_ ? "" : ",");
+		first_ = false;
+		firstField_ = true;
+	}
+
+	void field(const char * name, const char * value)
+	{
+		separator();
+		std::printf("\"%s\": \"%s\"", name, value);
+	}
+
+	void field(const char * name, const long long value)
+	{
+		separator();
+		std::printf("\"%s\": %lld", name, value);
+	}
+
+	void field(const char * name, const double value)
+	{
+		separator();
+		std::printf("\"%s\": %.6g", name, value);
+	}
+
+	void endResult() { std::printf("}"); }
+
+private:
+	void separator()
+	{
+		std::printf("%s", firstField_ ? "" : ", ");
+		firstField_ = false;
+	}
+
+private:
+	bool first_ = true;
+	bool firstField_ = true;
+};
+
+void writeMeasurement(JsonWriter & json, const fgl::Viewport & viewport, const Measurement & measurement)
+{
+	const auto pixels = static_cast<double>(viewport.width) * static_cast<double>(viewport.height);
+	const auto iterations = static_cast<double>(measurement.iterations);
+	json.field("seconds", measurement.seconds);
+	json.field("mpix_per_s", pixels / measurement.seconds * 1e-6);
+	json.field("giter_per_s", iterations / measurement.iterationSeconds * 1e-9);
+	json.field("ns_per_iter", nanosecondsPerIteration(measurement));
+	json.field("mean_iterations", iterations / pixels);
+	if (measurement.iterationSeconds != measurement.seconds)
+	{
+		json.field("periodicity_speedup", measurement.iterationSeconds / measurement.seconds);
+	}
+}
+
+// Times the Karatsuba product and square of N limbs against the schoolbook
+// ones, false if they differ.
+template <int N>
+bool writeLimbProducts(JsonWriter & json, const int repeats)
+{
+	using fgl::bignum::Limb;
+	std::mt19937 random{N};
+	std::array<Limb, N> a;
+	std::array<Limb, N> b;
+	std::array<Limb, 2 * N> product;
+	std::array<Limb, 2 * N> expected;
+	auto matches = true;
+	for (auto trial = 0; trial < g_limb_products; ++trial)
+	{
+		// All ones and zeros exercise the carries and the difference signs
+		for (auto i = 0; i < N; ++i)
+		{
+			a[i] = trial % 7 == 0 ? ~Limb{0} : static_cast<Limb>(random());
+			b[i] = trial % 11 == 0 ? Limb{0} : static_cast<Limb>(random());
+		}
+		fgl::bignum::multiply<N>(a.data(), b.data(), product.data());
+		fgl::bignum::schoolbookMultiply<N>(a.data(), b.data(), expected.data());
+		matches = matches && product == expected;
+		fgl::bignum::square<N>(a.data(), product.data());
+		fgl::bignum::schoolbookMultiply<N>(a.data(), a.data(), expected.data());
+		matches = matches && product == expected;
+	}
+
+	// Every product feeds the next, so none can be left out
+	const auto time = [&](const auto & product) {
+		const auto seconds = fastest(repeats, [&] {
+			for (auto i = 0; i < g_limb_products; ++i)
+			{
+				product();
+				a[0] ^= expected[N];
+			}
+		});
+		return seconds / g_limb_products * 1e9;
+	};
+	const auto multiplyNs = time([&] { fgl::bignum::multiply<N>(a.data(), b.data(), expected.data()); });
+	const auto schoolbookMultiplyNs = time([&] { fgl::bignum::schoolbookMultiply<N>(a.data(), b.data(), expected.data()); });
+	const auto squareNs = time([&] { fgl::bignum::square<N>(a.data(), expected.data()); });
+	const auto schoolbookSquareNs = time([&] { fgl::bignum::schoolbookSquare<N>(a.data(), expected.data()); });
+
+	json.beginResult();
+	json.field("viewport", "bignum");
+	json.field("limbs", static_cast<long long>(N));
+	json.field("karatsuba", N >= fgl::bignum::g_karatsuba_threshold ? "yes" : "no");
+	json.field("multiply_ns", multiplyNs);
+	json.field("schoolbook_multiply_ns", schoolbookMultiplyNs);
+	json.field("square_ns", squareNs);
+	json.field("schoolbook_square_ns", schoolbookSquareNs);
+	json.field("matches", matches ? "yes" : "no");
+	json.endResult();
+	if (!matches)
+	{
+		std::fprintf(stderr, "Karatsuba products of %d limbs differ from schoolbook ones\n", N);
+	}
+	return matches;
+}
+
+}// namespace
+
+int main(int argc, char ** argv)
+{
+	Settings settings;
+	if (!parseArguments(argc, argv, settings))
+	{
+		std::fprintf(stderr, "Usage: %s [--size WxH] [--repeats N] [--max-threads N] [--periodicity T]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	const auto hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	const auto maxThreads = settings.maxThreads > 0 ? settings.maxThreads : hardwareThreads;
+
+	std::printf("{\n  \"width\": %d,\n  \"height\": %d,\n  \"repeats\": %d,\n  \"hardware_threads\": %u,\n",
+				settings.width, settings.height, settings.repeats, hardwareThreads);
+	std::printf("  \"periodicity\": %g,\n", settings.periodicity);
+	std::printf("  \"best_kernel\": \"%s\",\n  \"results\": [", fgl::bestJuliaKernel().name);
+
+	JsonWriter json;
+	for (const auto & reference : references())
+	{
+		for (const auto cap : g_iteration_caps)
+		{
+			auto viewport = reference.viewport;
+			viewport.width = settings.width;
+			viewport.height = settings.height;
+			viewport.iterations = cap;
+
+			// Every kernel and precision on the calling thread
+			auto bestDouble = Measurement{};
+			for (const auto * kernel : fgl::supportedJuliaKernels())
+			{
+				for (const auto precision : {fgl::Precision::Float, fgl::Precision::Double})
+				{
+					fgl::RenderOptions options;
+					options.kernel = kernel;
+					options.precision = precision;
+					options.periodicityTolerance = settings.periodicity;
+					const auto measurement = measure(viewport, options, settings.repeats);
+					if (kernel == &fgl::bestJuliaKernel() && precision == fgl::Precision::Double)
+					{
+						bestDouble = measurement;
+					}
+
+					json.beginResult();
+					json.field("viewport", reference.name);
+					json.field("iterations", static_cast<long long>(cap));
+					json.field("kernel", kernel->name);
+					json.field("precision", precisionName(precision));
+					json.field("threads", 0LL);
+					writeMeasurement(json, viewport, measurement);
+					json.endResult();
+				}
+			}
+
+			// Extended precision with the best kernel on the calling thread
+			for (const auto precision : {fgl::Precision::DoubleDouble, fgl::Precision::QuadDouble})
+			{
+				fgl::RenderOptions options;
+				options.precision = precision;
+				options.periodicityTolerance = settings.periodicity;
+				const auto measurement = measureExtended(fgl::deepViewport(viewport), options, settings.repeats);
+
+				json.beginResult();
+				json.field("viewport", reference.name);
+				json.field("iterations", static_cast<long long>(cap));
+				json.field("kernel", fgl::bestJuliaKernel().name);
+				json.field("precision", precisionName(precision));
+				json.field("threads", 0LL);
+				writeMeasurement(json, viewport, measurement);
+				json.field("slowdown", nanosecondsPerIteration(measurement) / nanosecondsPerIteration(bestDouble));
+				json.endResult();
+			}
+
+			// Perturbation on the calling thread, it has no periodicity checking
+			{
+				fgl::DeepStats stats;
+				const auto measurement = measureDeep(fgl::deepViewport(viewport), {}, settings.repeats, stats);
+
+				json.beginResult();
+				json.field("viewport", reference.name);
+				json.field("iterations", static_cast<long long>(cap));
+				json.field("kernel", "perturbation");
+				json.field("precision", "double");
+				json.field("threads", 0LL);
+				writeMeasurement(json, viewport, measurement);
+				json.field("references", static_cast<long long>(stats.references));
+				json.endResult();
+			}
+
+			// Best kernel on the tile pool, efficiency is relative to one worker
+			auto singleWorkerSeconds = 0.0;
+			auto allWorkersSeconds = 0.0;
+			for (const auto threads : threadCounts(maxThreads))
+			{
+				fgl::TilePoolOptions poolOptions;
+				poolOptions.threadCount = threads;
+				fgl::TilePool pool{poolOptions};
+				fgl::RenderOptions options;
+				options.pool = &pool;
+				options.periodicityTolerance = settings.periodicity;
+				const auto measurement = measure(viewport, options, settings.repeats);
+				if (threads == 1)
+				{
+					singleWorkerSeconds = measurement.seconds;
+				}
+
+				json.beginResult();
+				json.field("viewport", reference.name);
+				json.field("iterations", static_cast<long long>(cap));
+				json.field("kernel", fgl::bestJuliaKernel().name);
+				json.field("precision", "float");
+				json.field("threads", static_cast<long long>(threads));
+				writeMeasurement(json, viewport, measurement);
+				json.field("efficiency", singleWorkerSeconds / (measurement.seconds * threads));
+				json.endResult();
+				allWorkersSeconds = measurement.seconds;
+			}
+
+			// Mariani-Silver subdivision on all workers, filled pixels count as
+			// the iterations they would have taken.
+			{
+				fgl::TilePoolOptions poolOptions;
+				poolOptions.threadCount = maxThreads;
+				fgl::TilePool pool{poolOptions};
+				fgl::RenderOptions options;
+				options.pool = &pool;
+				options.periodicityTolerance = settings.periodicity;
+				options.subdivide = true;
+				const auto measurement = measure(viewport, options, settings.repeats);
+
+				json.beginResult();
+				json.field("viewport", reference.name);
+				json.field("iterations", static_cast<long long>(cap));
+				json.field("kernel", fgl::bestJuliaKernel().name);
+				json.field("precision", "float");
+				json.field("threads", static_cast<long long>(maxThreads));
+				json.field("mode", "subdivide");
+				writeMeasurement(json, viewport, measurement);
+				json.field("speedup", allWorkersSeconds / measurement.seconds);
+				json.endResult();
+			}
+		}
+	}
+
+	// Zooms no plain kernel can render, on all workers
+	fgl::DeepViewport deep;
+	deep.view.width = settings.width;
+	deep.view.height = settings.height;
+	deep.view.param1 = 0.0f;
+	deep.view.param2 = -745.0f;
+	deep.view.param3 = 113.0f;
+	deep.view.iterations = g_deep_iterations;
+	repellingFixedPoint(deep.view, deep.centreX, deep.centreY);
+
+	// Zooms between double and perturbation, relative to perturbation there
+	for (const auto & extended : g_extended_zooms)
+	{
+		fgl::TilePoolOptions poolOptions;
+		poolOptions.threadCount = maxThreads;
+		fgl::TilePool pool{poolOptions};
+		deep.view.zoom = extended.zoom;
+		fgl::RenderOptions options;
+		options.pool = &pool;
+		options.precision = extended.precision;
+		options.periodicityTolerance = settings.periodicity;
+		const auto measurement = measureExtended(deep, options, settings.repeats);
+		fgl::DeepOptions deepOptions;
+		deepOptions.pool = &pool;
+		fgl::DeepStats stats;
+		const auto perturbation = measureDeep(deep, deepOptions, settings.repeats, stats);
+
+		json.beginResult();
+		json.field("viewport", "boundary-deep");
+		json.field("zoom", extended.zoom);
+		json.field("iterations", static_cast<long long>(g_deep_iterations));
+		json.field("kernel", fgl::bestJuliaKernel().name);
+		json.field("precision", precisionName(extended.precision));
+		json.field("threads", static_cast<long long>(maxThreads));
+		writeMeasurement(json, deep.view, measurement);
+		json.field("perturbation_ratio", measurement.seconds / perturbation.seconds);
+		json.endResult();
+	}
+
+	for (const auto zoom : g_deep_zooms)
+	{
+		fgl::TilePoolOptions poolOptions;
+		poolOptions.threadCount = maxThreads;
+		fgl::TilePool pool{poolOptions};
+		fgl::DeepOptions options;
+		options.pool = &pool;
+		deep.view.zoom = zoom;
+		fgl::DeepStats stats;
+		const auto measurement = measureDeep(deep, options, settings.repeats, stats);
+
+		json.beginResult();
+		json.field("viewport", "boundary-deep");
+		json.field("zoom", zoom);
+		json.field("iterations", static_cast<long long>(g_deep_iterations));
+		json.field("kernel", "perturbation");
+		json.field("precision", "double");
+		json.field("threads", static_cast<long long>(maxThreads));
+		writeMeasurement(json, deep.view, measurement);
+		json.field("limbs", static_cast<long long>(stats.limbs));
+		json.field("references", static_cast<long long>(stats.references));
+		json.field("skipped_iterations", static_cast<long long>(stats.skippedIterations));
+		json.field("glitched_pixels", static_cast<long long>(stats.glitchedPixels));
+		json.endResult();
+	}
+	// DeepReal and the sizes Karatsuba starts at
+	auto limbProductsMatch = writeLimbProducts<fgl::DeepReal::limbCount>(json, settings.repeats);
+	limbProductsMatch = writeLimbProducts<fgl::bignum::g_karatsuba_threshold>(json, settings.repeats) && limbProductsMatch;
+	limbProductsMatch = writeLimbProducts<2 * fgl::bignum::g_karatsuba_threshold>(json, settings.repeats) && limbProductsMatch;
+	std::printf("\n  ]\n}\n");
+	return limbProductsMatch ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+#include "CpuFeatures.hpp"
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define FGL_CPUID_MSVC
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#define FGL_CPUID_GNU
+#include <cpuid.h>
+#endif
+
+namespace fgl
+{
+
+namespace
+{
+
+#if defined(FGL_CPUID_MSVC) || defined(FGL_CPUID_GNU)
+
+struct CpuidRegisters
+{
+	std::uint32_t eax = 0;
+	std::uint32_t ebx = 0;
+	std::uint32_t ecx = 0;
+	std::uint32_t edx = 0;
+};
+
+CpuidRegisters cpuid(const std::uint32_t leaf, const std::uint32_t subleaf)
+{
+	CpuidRegisters registers;
+#if defined(FGL_CPUID_MSVC)
+	int values[4] = {};
+	__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+	registers.eax = static_cast<std::uint32_t>(values[0]);
+	registers.ebx = static_cast<std::uint32_t>(values[1]);
+	registers.ecx = static_cast<std::uint32_t>(values[2]);
+	registers.edx = static_cast<std::uint32_t>(values[3]);
+#else
+	__cpuid_count(leaf, subleaf, registers.eax, registers.ebx, registers.ecx, registers.edx);
+#endif
+	return registers;
+}
+
+std::uint64_t xgetbv()
+{
+#if defined(FGL_CPUID_MSVC)
+	return _xgetbv(0);
+#else
+	std::uint32_t eax = 0;
+	std::uint32_t edx = 0;
+	__asm__ volatile("xgetbv"
+					 : "=a"(eax), "=d"(edx)
+					 : "c"(0));
+	return (static_cast<std::uint64_t>(edx) << 32u) | eax;
+#endif
+}
+
+bool bit(const std::uint32_t value, const unsigned index) { return ((value >> index) & 1u) != 0; }
+
+CpuFeatures queryFeatures()
+{
+	CpuFeatures features;
+
+	const auto maxLeaf = cpuid(0, 0).eax;
+	if (maxLeaf < 1)
+	{
+		return features;
+	}
+
+	const auto leaf1 = cpuid(1, 0);
+	features.sse2 = bit(leaf1.edx, 26);
+
+	// AVX state has to be enabled by the OS, see XCR0.
+	const auto osxsave = bit(leaf1.ecx, 27);
+	const auto avx = bit(leaf1.ecx, 28);
+	if (!osxsave || !avx)
+	{
+		return features;
+	}
+	const auto xcr0 = xgetbv();
+	const auto ymmState = (xcr0 & 0x6u) == 0x6u;
+	const auto zmmState = (xcr0 & 0xe6u) == 0xe6u;
+	if (!ymmState || maxLeaf < 7)
+	{
+		return features;
+	}
+
+	const auto leaf7 = cpuid(7, 0);
+	features.fma = bit(leaf1.ecx, 12);
+	features.avx2 = bit(leaf7.ebx, 5);
+	features.avx512f = zmmState && bit(leaf7.ebx, 16);
+	return features;
+}
+
+#else
+
+CpuFeatures queryFeatures() { return CpuFeatures{}; }
+
+#endif
+
+}// namespace
+
+const CpuFeatures & cpuFeatures()
+{
+	static const CpuFeatures features = queryFeatures();
+	return features;
+}
+
+}// namespace fgl
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace fgl
+{
+
+// Instruction sets usable by this process, the OS must also save the
+// extended register state for AVX and AVX-512 to be reported.
+struct CpuFeatures
+{
+	bool sse2 = false;
+	bool avx2 = false;
+	bool fma = false;
+	bool avx512f = false;
+};
+
+// Queried once via cpuid on first use.
+const CpuFeatures & cpuFeatures();
+
+}// namespace fgl
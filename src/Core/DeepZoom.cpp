@@ -0,0 +1,415 @@
+#include "DeepZoom.hpp"
+
+#include "TilePool.hpp"
+#include "Trace.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Bits the reference keeps beyond the pixel spacing.
+constexpr auto g_guard_bits = 64.0;
+// Reference orbits stop once this far out so their squares keep fitting the
+// integer limb, pixels continue from there in plain double.
+constexpr auto g_reference_limit = 4096.0;
+// Series approximation may be off by this fraction of a (mapped) pixel.
+constexpr auto g_series_tolerance = 1e-9;
+// Pixels whose delta grew to this fraction of |Z| may leave the reference.
+constexpr auto g_direct_delta = 0.5;
+// Glitched pixels per task of the later passes.
+constexpr std::size_t g_pixels_per_task = 256;
+
+glm::dvec2 multiply(const glm::dvec2 & lhs, const glm::dvec2 & rhs)
+{
+	return {lhs.x * rhs.x - lhs.y * rhs.y, lhs.x * rhs.y + lhs.y * rhs.x};
+}
+
+double lengthSquared(const glm::dvec2 & value) { return value.x * value.x + value.y * value.y; }
+
+// Deltas of deep zooms underflow when squared.
+double magnitude(const glm::dvec2 & value) { return std::hypot(value.x, value.y); }
+
+double pixelSpacing(const Viewport & view) { return std::min(std::abs(view.pixelSpacingX()), std::abs(view.pixelSpacingY())); }
+
+struct Constants
+{
+	glm::dvec2 constant{0.0, 0.0};
+	int iterations = 0;
+	double bailoutSquared = 0.0;
+	double spacing = 0.0;
+	double glitchTolerance = 0.0;
+	double directSpread = 0.0;
+};
+
+Constants makeConstants(const Viewport & view, const DeepOptions & options)
+{
+	Constants constants;
+	constants.constant = {view.constantRe(), view.constantIm()};
+	constants.iterations = view.iterations;
+	constants.bailoutSquared = static_cast<double>(view.iterations) * static_cast<double>(view.iterations);
+	constants.spacing = pixelSpacing(view);
+	constants.glitchTolerance = options.glitchTolerance;
+	constants.directSpread = options.directSpread;
+	return constants;
+}
+
+struct PixelResult
+{
+	std::uint32_t count = 0;
+	// |z| / |Z| where the glitch was detected, 0 if there was none.
+	float glitch = 0.0f;
+};
+
+int referenceLimbs(const Viewport & view)
+{
+	const auto bits = g_guard_bits - std::log2(pixelSpacing(view));
+	for (const auto limbs : {4, 8, 16})
+	{
+		if (bits <= 32.0 * (limbs - 1))
+		{
+			return limbs;
+		}
+	}
+	return DeepReal::limbCount;
+}
+
+template <int Limbs>
+std::vector<OrbitPoint> iterateReference(const DeepReal & startX, const DeepReal & startY, const Constants & constants)
+{
+	using Real = FixedPoint<Limbs>;
+	Real x{startX};
+	Real y{startY};
+	const Real constantX{constants.constant.x};
+	const Real constantY{constants.constant.y};
+	const auto limitSquared = std::min(constants.bailoutSquared, g_reference_limit * g_reference_limit);
+	const auto toleranceSquared = constants.glitchTolerance * constants.glitchTolerance;
+	const auto infinity = std::numeric_limits<double>::infinity();
+
+	std::vector<OrbitPoint> orbit;
+	orbit.reserve(static_cast<std::size_t>(constants.iterations) + 1);
+	// |dZ/dZ_0| times the pixel spacing, how far apart neighbours are now.
+	auto spread = constants.spacing;
+	auto push = [&] {
+		const glm::dvec2 z{x.toDouble(), y.toDouble()};
+		const auto zSquared = lengthSquared(z);
+		const auto direct = spread > constants.directSpread * std::sqrt(zSquared);
+		orbit.push_back({z, toleranceSquared * zSquared, direct ? g_direct_delta * g_direct_delta * zSquared : infinity});
+		spread *= 2.0 * std::sqrt(zSquared);
+		return zSquared <= limitSquared;
+	};
+
+	auto inside = push();
+	for (auto count = 0; inside && count < constants.iterations; ++count)
+	{
+		// Squares take about half the limb products of a multiplication, so
+		// 2 x y = (x + y)^2 - x^2 - y^2 beats the product.
+		const auto xx = x.square();
+		const auto yy = y.square();
+		const auto sum = (x + y).square();
+		x = xx - yy + constantX;
+		y = sum - xx - yy + constantY;
+		inside = push();
+	}
+	return orbit;
+}
+
+std::vector<OrbitPoint> iterateReference(const DeepReal & startX, const DeepReal & startY, const int limbs, const Constants & constants)
+{
+	switch (limbs)
+	{
+		case 4:
+			return iterateReference<4>(startX, startY, constants);
+		case 8:
+			return iterateReference<8>(startX, startY, constants);
+		case 16:
+			return iterateReference<16>(startX, startY, constants);
+		default:
+			return iterateReference<DeepReal::limbCount>(startX, startY, constants);
+	}
+}
+
+// Runs the series up to the last iteration where it still predicts every
+// probe, iterated by perturbation alongside, within g_series_tolerance of
+// the distance neighbouring pixels have been mapped to. Probes are the
+// corners and edge midpoints, the pixels furthest from the reference.
+void approximateSeries(ReferenceOrbit & reference, const Viewport & view, const Constants & constants)
+{
+	const auto right = view.width - 1;
+	const auto bottom = view.height - 1;
+	const std::array<glm::ivec2, 8> probePixels = {{
+		{0, 0},
+		{right / 2, 0},
+		{right, 0},
+		{0, bottom / 2},
+		{right, bottom / 2},
+		{0, bottom},
+		{right / 2, bottom},
+		{right, bottom},
+	}};
+
+	std::array<glm::dvec2, probePixels.size()> probes;
+	std::array<glm::dvec2, probePixels.size()> deltas;
+	auto radius = 0.0;
+	for (std::size_t i = 0; i < probes.size(); ++i)
+	{
+		probes[i] = glm::dvec2{view.planeX(probePixels[i].x), view.planeY(probePixels[i].y)} - reference.offset;
+		deltas[i] = probes[i];
+		radius = std::max(radius, magnitude(probes[i]));
+	}
+	if (radius == 0.0)
+	{
+		return;
+	}
+	for (auto & probe : probes)
+	{
+		probe /= radius;
+	}
+
+	const auto spacing = constants.spacing;
+	const auto length = static_cast<int>(reference.points.size()) - 1;
+	glm::dvec2 a{radius, 0.0};
+	glm::dvec2 b{0.0, 0.0};
+	glm::dvec2 c{0.0, 0.0};
+	for (auto count = 0; count + 1 < length; ++count)
+	{
+		const auto twiceZ = 2.0 * reference.points[static_cast<std::size_t>(count)].z;
+		const auto nextA = multiply(twiceZ, a);
+		const auto nextB = multiply(twiceZ, b) + multiply(a, a);
+		const auto nextC = multiply(twiceZ, c) + 2.0 * multiply(a, b);
+
+		const auto & next = reference.points[static_cast<std::size_t>(count) + 1];
+		const auto allowed = g_series_tolerance * spacing / radius * magnitude(nextA);
+		for (std::size_t i = 0; i < probes.size(); ++i)
+		{
+			deltas[i] = multiply(twiceZ + deltas[i], deltas[i]);
+			const auto z = lengthSquared(next.z + deltas[i]);
+			if (z > constants.bailoutSquared || z < next.glitchSquared)
+			{
+				return;
+			}
+
+			const auto & u = probes[i];
+			const auto series = multiply(multiply(multiply(nextC, u) + nextB, u) + nextA, u);
+			if (!(magnitude(series - deltas[i]) <= allowed))
+			{
+				return;
+			}
+		}
+
+		a = nextA;
+		b = nextB;
+		c = nextC;
+		reference.skip = count + 1;
+		reference.radius = radius;
+		reference.a = a;
+		reference.b = b;
+		reference.c = c;
+	}
+}
+
+PixelResult iteratePixel(const ReferenceOrbit & reference, const glm::dvec2 & offset, const Constants & constants)
+{
+	auto delta = offset - reference.offset;
+	auto count = 0;
+	if (reference.skip > 0)
+	{
+		const auto u = delta / reference.radius;
+		delta = multiply(multiply(multiply(reference.c, u) + reference.b, u) + reference.a, u);
+		count = reference.skip;
+	}
+
+	const auto * orbit = reference.points.data();
+	const auto length = static_cast<int>(reference.points.size()) - 1;
+	while (count < constants.iterations)
+	{
+		const auto & point = orbit[count];
+		if (count == length || lengthSquared(delta) > point.directSquared)
+		{
+			// The reference escaped or this orbit left it, either way the
+			// pixels around are far enough apart for plain doubles.
+			auto z = point.z + delta;
+			while (count < constants.iterations)
+			{
+				++count;
+				z = multiply(z, z) + constants.constant;
+				if (lengthSquared(z) > constants.bailoutSquared)
+				{
+					break;
+				}
+			}
+			break;
+		}
+
+		delta = multiply(2.0 * point.z + delta, delta);
+		++count;
+		const auto & next = orbit[count];
+		const auto z = lengthSquared(next.z + delta);
+		if (z > constants.bailoutSquared)
+		{
+			break;
+		}
+		if (z < next.glitchSquared)
+		{
+			return {static_cast<std::uint32_t>(count), static_cast<float>(std::sqrt(z / lengthSquared(next.z)))};
+		}
+	}
+	return {static_cast<std::uint32_t>(count), 0.0f};
+}
+
+void renderPixel(const Viewport & view, const ReferenceOrbit & reference, const Constants & constants, const std::size_t index,
+				 gsl::span<std::uint32_t> iterations, std::vector<float> & glitches)
+{
+	const auto x = static_cast<int>(index % static_cast<std::size_t>(view.width));
+	const auto y = static_cast<int>(index / static_cast<std::size_t>(view.width));
+	const auto result = iteratePixel(reference, {view.planeX(x), view.planeY(y)}, constants);
+	iterations[index] = result.count;
+	glitches[index] = result.glitch;
+}
+
+ReferenceOrbit makeReference(const DeepViewport & viewport, const glm::dvec2 & offset, const Constants & constants,
+							 const DeepOptions & options)
+{
+	TraceZone zone{"deep reference"};
+	ReferenceOrbit reference;
+	reference.offset = offset;
+	reference.limbs = referenceLimbs(viewport.view);
+	reference.points = iterateReference(viewport.centreX + DeepReal{offset.x}, viewport.centreY + DeepReal{offset.y},
+										reference.limbs, constants);
+	if (options.seriesApproximation)
+	{
+		approximateSeries(reference, viewport.view, constants);
+	}
+	return reference;
+}
+
+}// namespace
+
+ReferenceOrbit referenceOrbit(const DeepViewport & viewport, const glm::dvec2 & offset, const DeepOptions & options)
+{
+	Expects(viewport.view.shiftX == 0.0 && viewport.view.shiftY == 0.0);
+	return makeReference(viewport, offset, makeConstants(viewport.view, options), options);
+}
+
+DeepViewport deepViewport(const Viewport & viewport)
+{
+	DeepViewport deep;
+	deep.view = viewport;
+	deep.view.shiftX = 0.0;
+	deep.view.shiftY = 0.0;
+	deep.centreX = DeepReal{viewport.shiftX / viewport.zoom};
+	deep.centreY = DeepReal{viewport.shiftY / viewport.zoom};
+	return deep;
+}
+
+DeepStats renderDeep(const DeepViewport & viewport, gsl::span<std::uint32_t> iterations, const DeepOptions & options)
+{
+	const auto & view = viewport.view;
+	const auto pixels = static_cast<std::size_t>(view.width) * static_cast<std::size_t>(view.height);
+	Expects(iterations.size() >= pixels);
+	Expects(view.shiftX == 0.0 && view.shiftY == 0.0);
+
+	DeepStats stats;
+	if (pixels == 0)
+	{
+		return stats;
+	}
+
+	const auto constants = makeConstants(view, options);
+
+	std::vector<float> glitches(pixels, 0.0f);
+	std::vector<std::size_t> pending;
+	glm::dvec2 offset{0.0, 0.0};
+	while (stats.references < std::max(1, options.maxReferences))
+	{
+		const auto reference = makeReference(viewport, offset, constants, options);
+		if (stats.references == 0)
+		{
+			stats.limbs = reference.limbs;
+			stats.skippedIterations = reference.skip;
+		}
+		++stats.references;
+
+		TraceZone zone{"deep pass"};
+		if (stats.references == 1)
+		{
+			const auto renderRow = [&](const std::size_t row) {
+				const auto first = row * static_cast<std::size_t>(view.width);
+				for (auto index = first; index < first + static_cast<std::size_t>(view.width); ++index)
+				{
+					renderPixel(view, reference, constants, index, iterations, glitches);
+				}
+			};
+			if (options.pool)
+			{
+				options.pool->run(static_cast<std::size_t>(view.height), renderRow);
+			}
+			else
+			{
+				for (std::size_t row = 0; row < static_cast<std::size_t>(view.height); ++row)
+				{
+					renderRow(row);
+				}
+			}
+		}
+		else
+		{
+			const auto renderChunk = [&](const std::size_t chunk) {
+				const auto first = chunk * g_pixels_per_task;
+				const auto last = std::min(pending.size(), first + g_pixels_per_task);
+				for (auto i = first; i < last; ++i)
+				{
+					renderPixel(view, reference, constants, pending[i], iterations, glitches);
+				}
+			};
+			const auto chunks = (pending.size() + g_pixels_per_task - 1) / g_pixels_per_task;
+			if (options.pool)
+			{
+				options.pool->run(chunks, renderChunk);
+			}
+			else
+			{
+				for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+				{
+					renderChunk(chunk);
+				}
+			}
+		}
+
+		// The most glitched pixel becomes the next reference, it sits where
+		// the old reference lost the orbits.
+		pending.clear();
+		auto worst = pixels;
+		for (std::size_t index = 0; index < pixels; ++index)
+		{
+			if (glitches[index] > 0.0f)
+			{
+				pending.push_back(index);
+				if (worst == pixels || glitches[index] < glitches[worst])
+				{
+					worst = index;
+				}
+			}
+		}
+		stats.glitchedPixels = pending.size();
+		if (pending.empty())
+		{
+			break;
+		}
+		const auto x = static_cast<int>(worst % static_cast<std::size_t>(view.width));
+		const auto y = static_cast<int>(worst / static_cast<std::size_t>(view.width));
+		offset = {view.planeX(x), view.planeY(y)};
+	}
+	return stats;
+}
+
+}// namespace fgl
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Core/FixedPoint.hpp>
+#include <Core/Viewport.hpp>
+
+#include <glm/vec2.hpp>
+#include <gsl/span>
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+class TilePool;
+
+// 992 fraction bits, enough for pixel spacings down to about 1e-290 where
+// the double deltas of the pixels start to underflow.
+using DeepReal = FixedPoint<32>;
+
+// Viewport whose centre keeps more bits than a double. view.shiftX and
+// view.shiftY stay 0, so view.planeX() and view.planeY() are the offsets of
+// a pixel from the centre and view.zoom may go far beyond 1e16.
+struct DeepViewport
+{
+	Viewport view;
+	DeepReal centreX;
+	DeepReal centreY;
+};
+
+// Same picture as the plain viewport.
+DeepViewport deepViewport(const Viewport & viewport);
+
+struct DeepOptions
+{
+	// Splits every pass into rows and renders them on the pool.
+	TilePool * pool = nullptr;
+	// Skips the iterations a cubic series in the pixel offset predicts well.
+	bool seriesApproximation = true;
+	// A pixel whose orbit comes closer to 0 than this fraction of the
+	// reference orbit has lost the precision of its delta (Pauldelbrot).
+	double glitchTolerance = 1e-3;
+	// Glitched pixels get new reference orbits until this many were used.
+	int maxReferences = 16;
+	// Once the orbit has spread neighbouring pixels this far apart relative
+	// to |Z|, the type deltas are iterated in resolves them without the
+	// reference, pixels whose delta grew as large as the orbit leave it.
+	double directSpread = 1e-8;
+};
+
+struct OrbitPoint
+{
+	glm::dvec2 z{0.0, 0.0};
+	// Pixels closer to 0 than this are glitched at this iteration.
+	double glitchSquared = 0.0;
+	// Pixels with a longer delta continue without the reference from here,
+	// infinity while neighbours are still too close.
+	double directSquared = 0.0;
+};
+
+// Reference orbit and the series approximation of the deltas around it.
+struct ReferenceOrbit
+{
+	// Reference point relative to the viewport centre, in plane units.
+	glm::dvec2 offset{0.0, 0.0};
+	// Z_0 up to the point where it escaped or the cap was reached.
+	std::vector<OrbitPoint> points;
+	// Limbs of the fixed-point type it was computed with.
+	int limbs = 0;
+
+	// The delta after skip iterations is ((c u + b) u + a) u, u is the pixel
+	// delta divided by radius. Scaling by radius keeps the coefficients in
+	// range where the plain ones would overflow a double.
+	int skip = 0;
+	double radius = 1.0;
+	glm::dvec2 a{0.0, 0.0};
+	glm::dvec2 b{0.0, 0.0};
+	glm::dvec2 c{0.0, 0.0};
+};
+
+struct DeepStats
+{
+	// Limbs of the fixed-point type the reference orbits were computed with.
+	int limbs = 0;
+	int references = 0;
+	// Iterations the series approximation skipped for the first reference.
+	int skippedIterations = 0;
+	// Pixels still glitched after the last reference, their counts are the
+	// iteration the glitch was detected at.
+	std::size_t glitchedPixels = 0;
+};
+
+// Reference orbit of the point offset from the viewport centre, for
+// renderers that iterate the deltas themselves such as the GPU path.
+ReferenceOrbit referenceOrbit(const DeepViewport & viewport, const glm::dvec2 & offset, const DeepOptions & options = {});
+
+// Computes the same iteration counts as renderJulia() in double precision,
+// but with perturbation: one reference orbit is iterated in fixed point, and
+// every pixel only iterates its double delta from it,
+//   d' = (2 Z + d) d,
+// which stays accurate however deep the zoom. Once the delta is as large as
+// the orbit and the pixels around have spread far enough apart the pixel
+// continues in plain double. Buffer layout as renderJulia().
+DeepStats renderDeep(const DeepViewport & viewport, gsl::span<std::uint32_t> iterations, const DeepOptions & options = {});
+
+}// namespace fgl
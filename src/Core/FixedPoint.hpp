@@ -0,0 +1,376 @@
+#pragma once
+
+#include <gsl/assert>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace fgl
+{
+
+// Arithmetic on unsigned little endian limb arrays whose lengths are known at
+// compile time, the building blocks of FixedPoint. Carries and signs travel
+// as values and masks instead of branches, so a loop runs the same way for
+// every input and the compiler can unroll it completely.
+namespace bignum
+{
+
+using Limb = std::uint32_t;
+using Wide = std::uint64_t;
+
+// Below this many limbs the additions Karatsuba trades for a quarter of the
+// products cost more than they save, measured on x86-64. At DeepReal's 32
+// limbs the product only breaks even and the square gets slower, so it keeps
+// the schoolbook loops. fractal-bench checks and times both sides of it.
+constexpr int g_karatsuba_threshold = 64;
+
+// out = a + b, returns the carry out of the top limb.
+template <int N>
+Limb add(const Limb * a, const Limb * b, Limb * out)
+{
+	Wide carry = 0;
+	for (auto i = 0; i < N; ++i)
+	{
+		const auto sum = static_cast<Wide>(a[i]) + b[i] + carry;
+		out[i] = static_cast<Limb>(sum);
+		carry = sum >> 32;
+	}
+	return static_cast<Limb>(carry);
+}
+
+// out = a - b, returns 1 if it borrowed out of the top limb.
+template <int N>
+Limb subtract(const Limb * a, const Limb * b, Limb * out)
+{
+	Wide borrow = 0;
+	for (auto i = 0; i < N; ++i)
+	{
+		const auto difference = static_cast<Wide>(a[i]) - b[i] - borrow;
+		out[i] = static_cast<Limb>(difference);
+		borrow = difference >> 63;
+	}
+	return static_cast<Limb>(borrow);
+}
+
+// Two's complement negation where mask is all ones, nothing where it is 0.
+template <int N>
+void negateIf(Limb * a, const Limb mask)
+{
+	Wide carry = mask & 1u;
+	for (auto i = 0; i < N; ++i)
+	{
+		const auto sum = static_cast<Wide>(a[i] ^ mask) + carry;
+		a[i] = static_cast<Limb>(sum);
+		carry = sum >> 32;
+	}
+}
+
+// out = |a - b|, returns all ones if a < b and 0 otherwise.
+template <int N>
+Limb absoluteDifference(const Limb * a, const Limb * b, Limb * out)
+{
+	const auto mask = Limb{0} - subtract<N>(a, b, out);
+	negateIf<N>(out, mask);
+	return mask;
+}
+
+// Adds the N limbs of value to the M limbs of out, carrying through all of
+// them. Anything carried out of out is dropped.
+template <int N, int M>
+void addInto(Limb * out, const Limb * value)
+{
+	static_assert(N <= M, "The value has to fit the destination");
+	Wide carry = 0;
+	for (auto i = 0; i < M; ++i)
+	{
+		const auto sum = static_cast<Wide>(out[i]) + (i < N ? value[i] : 0) + carry;
+		out[i] = static_cast<Limb>(sum);
+		carry = sum >> 32;
+	}
+}
+
+// 2N limb product, one row of partial products per limb of a.
+template <int N>
+void schoolbookMultiply(const Limb * a, const Limb * b, Limb * out)
+{
+	for (auto i = 0; i < 2 * N; ++i)
+	{
+		out[i] = 0;
+	}
+	for (auto i = 0; i < N; ++i)
+	{
+		Wide carry = 0;
+		for (auto j = 0; j < N; ++j)
+		{
+			const auto sum = static_cast<Wide>(a[i]) * b[j] + out[i + j] + carry;
+			out[i + j] = static_cast<Limb>(sum);
+			carry = sum >> 32;
+		}
+		out[i + N] = static_cast<Limb>(carry);
+	}
+}
+
+// 2N limb square with every cross product a_i a_j computed once: the rows
+// above the diagonal are summed, doubled in one shift and the squares a_i^2
+// added in the same pass.
+template <int N>
+void schoolbookSquare(const Limb * a, Limb * out)
+{
+	for (auto i = 0; i < 2 * N; ++i)
+	{
+		out[i] = 0;
+	}
+	for (auto i = 0; i < N - 1; ++i)
+	{
+		Wide carry = 0;
+		for (auto j = i + 1; j < N; ++j)
+		{
+			const auto sum = static_cast<Wide>(a[i]) * a[j] + out[i + j] + carry;
+			out[i + j] = static_cast<Limb>(sum);
+			carry = sum >> 32;
+		}
+		out[i + N] = static_cast<Limb>(carry);
+	}
+
+	Wide carry = 0;
+	// Top bit of the limb below, shifted into the next one.
+	Limb shifted = 0;
+	for (auto i = 0; i < N; ++i)
+	{
+		const auto diagonal = static_cast<Wide>(a[i]) * a[i];
+		const auto low = static_cast<Wide>((out[2 * i] << 1) | shifted) + static_cast<Limb>(diagonal) + carry;
+		shifted = out[2 * i] >> 31;
+		const auto high = static_cast<Wide>((out[2 * i + 1] << 1) | shifted) + (diagonal >> 32) + (low >> 32);
+		shifted = out[2 * i + 1] >> 31;
+		out[2 * i] = static_cast<Limb>(low);
+		out[2 * i + 1] = static_cast<Limb>(high);
+		carry = high >> 32;
+	}
+}
+
+// 2N limb product. From g_karatsuba_threshold limbs on, with a = a1 B + a0
+// and b = b1 B + b0 split into halves,
+//   a1 b0 + a0 b1 = a0 b0 + a1 b1 + (a0 - a1)(b1 - b0),
+// which takes three half products instead of four. The differences are
+// taken as magnitude and sign so every half product stays H limbs wide.
+template <int N>
+void multiply(const Limb * a, const Limb * b, Limb * out)
+{
+	if constexpr (N < g_karatsuba_threshold || N % 2 != 0)
+	{
+		schoolbookMultiply<N>(a, b, out);
+	}
+	else
+	{
+		constexpr auto H = N / 2;
+		multiply<H>(a, b, out);
+		multiply<H>(a + H, b + H, out + N);
+
+		std::array<Limb, H> differenceA;
+		std::array<Limb, H> differenceB;
+		const auto signA = absoluteDifference<H>(a, a + H, differenceA.data());
+		const auto signB = absoluteDifference<H>(b + H, b, differenceB.data());
+		std::array<Limb, N> cross;
+		multiply<H>(differenceA.data(), differenceB.data(), cross.data());
+
+		// The middle term is never negative, so N + 1 limbs of two's
+		// complement hold it whichever way the cross product goes.
+		std::array<Limb, N + 1> middle;
+		middle[N] = add<N>(out, out + N, middle.data());
+		// Adds the cross product or its complement plus one, sign extended.
+		const auto negative = signA ^ signB;
+		Wide carry = negative & 1u;
+		for (auto i = 0; i < N; ++i)
+		{
+			const auto sum = static_cast<Wide>(middle[i]) + (cross[i] ^ negative) + carry;
+			middle[i] = static_cast<Limb>(sum);
+			carry = sum >> 32;
+		}
+		middle[N] += static_cast<Limb>(carry) + negative;
+		addInto<N + 1, N + H>(out + H, middle.data());
+	}
+}
+
+// 2N limb square, Karatsuba as multiply() with
+//   2 a1 a0 = a0^2 + a1^2 - (a0 - a1)^2.
+template <int N>
+void square(const Limb * a, Limb * out)
+{
+	if constexpr (N < g_karatsuba_threshold || N % 2 != 0)
+	{
+		schoolbookSquare<N>(a, out);
+	}
+	else
+	{
+		constexpr auto H = N / 2;
+		square<H>(a, out);
+		square<H>(a + H, out + N);
+
+		std::array<Limb, H> difference;
+		absoluteDifference<H>(a, a + H, difference.data());
+		std::array<Limb, N> cross;
+		square<H>(difference.data(), cross.data());
+
+		std::array<Limb, N + 1> middle;
+		middle[N] = add<N>(out, out + N, middle.data());
+		middle[N] -= subtract<N>(middle.data(), cross.data(), middle.data());
+		addInto<N + 1, N + H>(out + H, middle.data());
+	}
+}
+
+}// namespace bignum
+
+// Signed fixed-point number of Limbs 32-bit limbs in two's complement, least
+// significant limb first. The top limb is the integer part, the others the
+// fraction, so values must stay within +-2^31. Used for the reference orbits
+// of deep zooms, where a double runs out of bits long before the iteration
+// does. Header only so every limb count gets fully unrolled loops.
+template <int Limbs>
+class FixedPoint
+{
+	static_assert(Limbs >= 2, "FixedPoint needs an integer and a fraction limb");
+
+public:
+	static constexpr int limbCount = Limbs;
+	static constexpr int fractionBits = 32 * (Limbs - 1);
+
+	FixedPoint() = default;
+
+	// Exact as long as the fraction has room for all bits of value.
+	explicit FixedPoint(const double value)
+	{
+		Expects(std::isfinite(value) && std::abs(value) < 2147483648.0);
+		if (value == 0.0)
+		{
+			return;
+		}
+
+		auto exponent = 0;
+		const auto mantissa = static_cast<std::uint64_t>(std::ldexp(std::frexp(std::abs(value), &exponent), 53));
+		// Position of the lowest mantissa bit in the raw integer.
+		const auto shift = exponent - 53 + fractionBits;
+		for (auto i = 0; i < Limbs; ++i)
+		{
+			const auto down = 32 * i - shift;
+			if (down >= 0)
+			{
+				limbs_[i] = down < 64 ? static_cast<std::uint32_t>(mantissa >> down) : 0;
+			}
+			else
+			{
+				limbs_[i] = -down < 32 ? static_cast<std::uint32_t>(mantissa << -down) : 0;
+			}
+		}
+		if (value < 0.0)
+		{
+			*this = -*this;
+		}
+	}
+
+	// Drops or zero extends fraction limbs.
+	template <int Other>
+	explicit FixedPoint(const FixedPoint<Other> & other)
+	{
+		for (auto i = 0; i < Limbs; ++i)
+		{
+			const auto source = i + Other - Limbs;
+			limbs_[i] = source >= 0 ? other.limbs_[source] : 0;
+		}
+	}
+
+	// Only the three limbs from the highest non-zero one on can reach the 53
+	// bits of a double, so values a double holds convert back exactly.
+	double toDouble() const
+	{
+		const auto magnitude = absolute(*this);
+		auto top = Limbs - 1;
+		while (top > 0 && magnitude.limbs_[top] == 0)
+		{
+			--top;
+		}
+		// Least significant first so small limbs are not lost to rounding early.
+		auto result = 0.0;
+		for (auto i = top >= 2 ? top - 2 : 0; i <= top; ++i)
+		{
+			result += std::ldexp(static_cast<double>(magnitude.limbs_[i]), 32 * i - fractionBits);
+		}
+		return negative() ? -result : result;
+	}
+
+	bool negative() const { return (limbs_[Limbs - 1] & 0x80000000u) != 0; }
+
+	FixedPoint operator-() const
+	{
+		auto result = *this;
+		bignum::negateIf<Limbs>(result.limbs_.data(), ~bignum::Limb{0});
+		return result;
+	}
+
+	FixedPoint & operator+=(const FixedPoint & rhs)
+	{
+		bignum::add<Limbs>(limbs_.data(), rhs.limbs_.data(), limbs_.data());
+		return *this;
+	}
+
+	FixedPoint & operator-=(const FixedPoint & rhs)
+	{
+		bignum::subtract<Limbs>(limbs_.data(), rhs.limbs_.data(), limbs_.data());
+		return *this;
+	}
+
+	friend bool operator==(const FixedPoint & lhs, const FixedPoint & rhs) { return lhs.limbs_ == rhs.limbs_; }
+	friend bool operator!=(const FixedPoint & lhs, const FixedPoint & rhs) { return lhs.limbs_ != rhs.limbs_; }
+
+	friend FixedPoint operator+(FixedPoint lhs, const FixedPoint & rhs) { return lhs += rhs; }
+	friend FixedPoint operator-(FixedPoint lhs, const FixedPoint & rhs) { return lhs -= rhs; }
+
+	// Truncates towards zero.
+	friend FixedPoint operator*(const FixedPoint & lhs, const FixedPoint & rhs)
+	{
+		std::array<bignum::Limb, 2 * Limbs> product;
+		bignum::multiply<Limbs>(absolute(lhs).limbs_.data(), absolute(rhs).limbs_.data(), product.data());
+		return fromProduct(product, lhs.signMask() ^ rhs.signMask());
+	}
+
+	// Same as *this * *this for about half the limb products.
+	FixedPoint square() const
+	{
+		std::array<bignum::Limb, 2 * Limbs> product;
+		bignum::square<Limbs>(absolute(*this).limbs_.data(), product.data());
+		return fromProduct(product, 0);
+	}
+
+	const std::array<std::uint32_t, Limbs> & limbs() const { return limbs_; }
+
+private:
+	template <int>
+	friend class FixedPoint;
+
+	// All ones for negative values, 0 otherwise.
+	bignum::Limb signMask() const { return bignum::Limb{0} - (limbs_[Limbs - 1] >> 31); }
+
+	static FixedPoint absolute(FixedPoint value)
+	{
+		bignum::negateIf<Limbs>(value.limbs_.data(), value.signMask());
+		return value;
+	}
+
+	// The Limbs limbs of a product of magnitudes at the fixed point position,
+	// negated where sign is all ones.
+	static FixedPoint fromProduct(const std::array<bignum::Limb, 2 * Limbs> & product, const bignum::Limb sign)
+	{
+		FixedPoint result;
+		for (auto i = 0; i < Limbs; ++i)
+		{
+			result.limbs_[i] = product[i + Limbs - 1];
+		}
+		bignum::negateIf<Limbs>(result.limbs_.data(), sign);
+		return result;
+	}
+
+private:
+	std::array<std::uint32_t, Limbs> limbs_{};
+};
+
+}// namespace fgl
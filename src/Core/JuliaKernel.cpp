@@ -0,0 +1,95 @@
+#include "JuliaKernel.hpp"
+
+#include "CpuFeatures.hpp"
+#include "JuliaKernelImpl.hpp"
+
+namespace fgl
+{
+
+namespace
+{
+
+using RowFloat = void (*)(const JuliaRowF &);
+using RowDouble = void (*)(const JuliaRowD &);
+using RowDoubleDouble = void (*)(const JuliaRowDD &);
+using RowQuadDouble = void (*)(const JuliaRowQD &);
+
+const JuliaKernel scalarKernel{
+	KernelIsa::Scalar, "scalar", 1, 1,
+	static_cast<RowFloat>(kernels::juliaRowScalar), static_cast<RowDouble>(kernels::juliaRowScalar),
+	static_cast<RowDoubleDouble>(kernels::juliaRowScalar), static_cast<RowQuadDouble>(kernels::juliaRowScalar),
+	kernels::juliaOrbitsScalar};
+
+#if FGL_KERNELS_X86
+const JuliaKernel sse2Kernel{
+	KernelIsa::Sse2, "sse2", 4, 2,
+	static_cast<RowFloat>(kernels::juliaRowSse2), static_cast<RowDouble>(kernels::juliaRowSse2),
+	static_cast<RowDoubleDouble>(kernels::juliaRowSse2), static_cast<RowQuadDouble>(kernels::juliaRowSse2),
+	kernels::juliaOrbitsSse2};
+
+const JuliaKernel avx2Kernel{
+	KernelIsa::Avx2, "avx2", 8, 4,
+	static_cast<RowFloat>(kernels::juliaRowAvx2), static_cast<RowDouble>(kernels::juliaRowAvx2),
+	static_cast<RowDoubleDouble>(kernels::juliaRowAvx2), static_cast<RowQuadDouble>(kernels::juliaRowAvx2),
+	kernels::juliaOrbitsAvx2};
+
+const JuliaKernel avx512Kernel{
+	KernelIsa::Avx512, "avx512", 16, 8,
+	static_cast<RowFloat>(kernels::juliaRowAvx512), static_cast<RowDouble>(kernels::juliaRowAvx512),
+	static_cast<RowDoubleDouble>(kernels::juliaRowAvx512), static_cast<RowQuadDouble>(kernels::juliaRowAvx512),
+	kernels::juliaOrbitsAvx512};
+#endif
+
+const JuliaKernel * selectBestKernel()
+{
+	const JuliaKernel * best = &scalarKernel;
+	for (const auto * kernel : supportedJuliaKernels())
+	{
+		best = kernel;
+	}
+	return best;
+}
+
+}// namespace
+
+const JuliaKernel & bestJuliaKernel()
+{
+	static const JuliaKernel * const best = selectBestKernel();
+	return *best;
+}
+
+const JuliaKernel * juliaKernel(const KernelIsa isa)
+{
+	const auto & features = cpuFeatures();
+	switch (isa)
+	{
+		case KernelIsa::Scalar:
+			return &scalarKernel;
+#if FGL_KERNELS_X86
+		case KernelIsa::Sse2:
+			return features.sse2 ? &sse2Kernel : nullptr;
+		case KernelIsa::Avx2:
+			return features.avx2 ? &avx2Kernel : nullptr;
+		case KernelIsa::Avx512:
+			return features.avx512f ? &avx512Kernel : nullptr;
+#endif
+		default:
+			static_cast<void>(features);
+			return nullptr;
+	}
+}
+
+std::vector<const JuliaKernel *> supportedJuliaKernels()
+{
+	std::vector<const JuliaKernel *> kernels;
+	for (const auto isa : {KernelIsa::Scalar, KernelIsa::Sse2, KernelIsa::Avx2, KernelIsa::Avx512})
+	{
+		if (const auto * kernel = juliaKernel(isa))
+		{
+			kernels.push_back(kernel);
+		}
+	}
+	return kernels;
+}
+
+}// namespace fgl
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+enum class KernelIsa
+{
+	Scalar,
+	Sse2,
+	Avx2,
+	Avx512,
+};
+
+// A row of evenly spaced points, point i is start + ((first + i) * step, 0).
+// Keeping start at the left edge of the viewport makes the coordinates
+// independent of how a frame is split into tiles.
+// Each output is the number of iterations julia() in Shaders/diffuse.fs
+// performs for that point, the bailout radius equals iterations.
+// With periodEpsilon set the orbit is compared against a point saved at
+// iterations 1, 2, 4, 8, ... (Brent), once it comes back within that
+// distance it is a cycle that never escapes and the output is iterations.
+template <typename T>
+struct JuliaRow
+{
+	glm::vec<2, T> start{0, 0};
+	T step = 0;
+	int first = 0;
+	// Walk down a column instead, point i is start + (0, (first + i) * step).
+	bool column = false;
+	glm::vec<2, T> constant{0, 0};
+	int iterations = 0;
+	// 0 disables periodicity checking.
+	T periodEpsilon = 0;
+	int count = 0;
+	std::uint32_t * out = nullptr;
+};
+
+using JuliaRowF = JuliaRow<float>;
+using JuliaRowD = JuliaRow<double>;
+
+// Row for the extended precision kernels, every real is the unevaluated sum
+// of Terms doubles, largest first. Point i is centre + offset + the step
+// along the row or column as in JuliaRow, only the centre needs the extra
+// bits. periodEpsilon is compared against the leading term of the distance.
+template <int Terms>
+struct JuliaRowExtended
+{
+	std::array<double, Terms> centreX{};
+	std::array<double, Terms> centreY{};
+	glm::dvec2 offset{0, 0};
+	double step = 0;
+	int first = 0;
+	bool column = false;
+	glm::dvec2 constant{0, 0};
+	int iterations = 0;
+	double periodEpsilon = 0;
+	int count = 0;
+	std::uint32_t * out = nullptr;
+};
+
+// About 106 and 212 mantissa bits.
+using JuliaRowDD = JuliaRowExtended<2>;
+using JuliaRowQD = JuliaRowExtended<4>;
+
+// States of a continued orbit.
+constexpr std::uint32_t orbitIterating = 0;
+constexpr std::uint32_t orbitEscaped = 1;
+constexpr std::uint32_t orbitCycled = 2;
+
+// Float orbits of count points kept between calls, structure of arrays, see
+// Core/OrbitBuffer.hpp. Every point in state orbitIterating advances until
+// it has done iterations steps. A point whose next step would take |z|^2
+// beyond escapeRadiusSquared stays before that step and becomes
+// orbitEscaped, a row kernel with that bailout counts steps + 1 for it. The
+// periodicity check runs as in JuliaRow, a cycle becomes orbitCycled. A new
+// orbit starts with z0, steps 0, nextSave 1 and the saved point z0.
+struct JuliaOrbitsF
+{
+	float * x = nullptr;
+	float * y = nullptr;
+	float * savedX = nullptr;
+	float * savedY = nullptr;
+	std::uint32_t * steps = nullptr;
+	// Step after which the periodicity check saves the point, powers of two.
+	std::uint32_t * nextSave = nullptr;
+	std::uint32_t * state = nullptr;
+	glm::vec2 constant{0, 0};
+	float escapeRadiusSquared = 4;
+	int iterations = 0;
+	float periodEpsilon = 0;
+	int count = 0;
+};
+
+// Set of row kernels compiled for one instruction set.
+struct JuliaKernel
+{
+	KernelIsa isa = KernelIsa::Scalar;
+	const char * name = "";
+	// Pixels processed by one instruction stream.
+	int floatLanes = 1;
+	int doubleLanes = 1;
+	void (*rowFloat)(const JuliaRowF & row) = nullptr;
+	void (*rowDouble)(const JuliaRowD & row) = nullptr;
+	// Lanes as for double, every lane carries one extended value.
+	void (*rowDoubleDouble)(const JuliaRowDD & row) = nullptr;
+	void (*rowQuadDouble)(const JuliaRowQD & row) = nullptr;
+	void (*orbitsFloat)(const JuliaOrbitsF & orbits) = nullptr;
+};
+
+// The fastest kernel this CPU supports, picked once via cpuid.
+const JuliaKernel & bestJuliaKernel();
+
+// Kernel for the given instruction set, nullptr if the CPU or build lacks it.
+const JuliaKernel * juliaKernel(KernelIsa isa);
+
+// All kernels usable on this CPU, slowest first.
+std::vector<const JuliaKernel *> supportedJuliaKernels();
+
+}// namespace fgl
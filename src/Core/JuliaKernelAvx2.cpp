@@ -0,0 +1,263 @@
+#include "JuliaKernelExtended.hpp"
+#include "JuliaKernelImpl.hpp"
+
+#if FGL_KERNELS_X86
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+namespace fgl
+{
+namespace kernels
+{
+
+void juliaRowAvx2(const JuliaRowF & row)
+{
+	constexpr auto lanes = 8;
+	const auto bailout = static_cast<float>(row.iterations);
+	const auto bailoutSquared = _mm256_set1_ps(bailout * bailout);
+	const auto cRe = _mm256_set1_ps(row.constant.x);
+	const auto cIm = _mm256_set1_ps(row.constant.y);
+	const auto laneOffsets = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+	const auto step = _mm256_set1_ps(row.step);
+	const auto checkPeriod = row.periodEpsilon > 0.0f;
+	const auto epsilonSquared = _mm256_set1_ps(row.periodEpsilon * row.periodEpsilon);
+	const auto cap = _mm256_set1_epi32(row.iterations);
+
+	alignas(32) std::uint32_t counts[lanes];
+	for (auto i = 0; i < row.count; i += lanes)
+	{
+		const auto index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(row.first + i)), laneOffsets);
+		const auto along = _mm256_mul_ps(index, step);
+		auto x = row.column ? _mm256_set1_ps(row.start.x) : _mm256_add_ps(_mm256_set1_ps(row.start.x), along);
+		auto y = row.column ? _mm256_add_ps(_mm256_set1_ps(row.start.y), along) : _mm256_set1_ps(row.start.y);
+		auto active = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		auto count = _mm256_setzero_si256();
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		for (auto n = 0; n < row.iterations; ++n)
+		{
+			// Active lanes are all ones, subtracting adds one.
+			count = _mm256_sub_epi32(count, _mm256_castps_si256(active));
+			const auto xx = _mm256_mul_ps(x, x);
+			const auto yy = _mm256_mul_ps(y, y);
+			const auto xy = _mm256_mul_ps(x, y);
+			x = _mm256_add_ps(_mm256_sub_ps(xx, yy), cRe);
+			y = _mm256_add_ps(_mm256_add_ps(xy, xy), cIm);
+			const auto magnitude = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+			active = _mm256_andnot_ps(_mm256_cmp_ps(magnitude, bailoutSquared, _CMP_GT_OQ), active);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm256_sub_ps(x, savedX);
+				const auto dy = _mm256_sub_ps(y, savedY);
+				const auto distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+				const auto cycled = _mm256_castps_si256(_mm256_and_ps(_mm256_cmp_ps(distance, epsilonSquared, _CMP_LT_OQ), active));
+				// A cycle never escapes, its count jumps to the cap.
+				count = _mm256_or_si256(_mm256_andnot_si256(cycled, count), _mm256_and_si256(cycled, cap));
+				active = _mm256_andnot_ps(_mm256_castsi256_ps(cycled), active);
+				if (n + 1 == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+
+			if (_mm256_movemask_ps(active) == 0)
+			{
+				break;
+			}
+		}
+
+		_mm256_store_si256(reinterpret_cast<__m256i *>(counts), count);
+		std::copy_n(counts, std::min(lanes, row.count - i), row.out + i);
+	}
+}
+
+void juliaRowAvx2(const JuliaRowD & row)
+{
+	constexpr auto lanes = 4;
+	const auto bailout = static_cast<double>(row.iterations);
+	const auto bailoutSquared = _mm256_set1_pd(bailout * bailout);
+	const auto cRe = _mm256_set1_pd(row.constant.x);
+	const auto cIm = _mm256_set1_pd(row.constant.y);
+	const auto laneOffsets = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+	const auto step = _mm256_set1_pd(row.step);
+	const auto checkPeriod = row.periodEpsilon > 0.0;
+	const auto epsilonSquared = _mm256_set1_pd(row.periodEpsilon * row.periodEpsilon);
+	const auto cap = _mm256_set1_epi64x(row.iterations);
+
+	alignas(32) std::uint64_t counts[lanes];
+	for (auto i = 0; i < row.count; i += lanes)
+	{
+		const auto index = _mm256_add_pd(_mm256_set1_pd(static_cast<double>(row.first + i)), laneOffsets);
+		const auto along = _mm256_mul_pd(index, step);
+		auto x = row.column ? _mm256_set1_pd(row.start.x) : _mm256_add_pd(_mm256_set1_pd(row.start.x), along);
+		auto y = row.column ? _mm256_add_pd(_mm256_set1_pd(row.start.y), along) : _mm256_set1_pd(row.start.y);
+		auto active = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+		auto count = _mm256_setzero_si256();
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		for (auto n = 0; n < row.iterations; ++n)
+		{
+			count = _mm256_sub_epi64(count, _mm256_castpd_si256(active));
+			const auto xx = _mm256_mul_pd(x, x);
+			const auto yy = _mm256_mul_pd(y, y);
+			const auto xy = _mm256_mul_pd(x, y);
+			x = _mm256_add_pd(_mm256_sub_pd(xx, yy), cRe);
+			y = _mm256_add_pd(_mm256_add_pd(xy, xy), cIm);
+			const auto magnitude = _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y));
+			active = _mm256_andnot_pd(_mm256_cmp_pd(magnitude, bailoutSquared, _CMP_GT_OQ), active);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm256_sub_pd(x, savedX);
+				const auto dy = _mm256_sub_pd(y, savedY);
+				const auto distance = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+				const auto cycled = _mm256_castpd_si256(_mm256_and_pd(_mm256_cmp_pd(distance, epsilonSquared, _CMP_LT_OQ), active));
+				// A cycle never escapes, its count jumps to the cap.
+				count = _mm256_or_si256(_mm256_andnot_si256(cycled, count), _mm256_and_si256(cycled, cap));
+				active = _mm256_andnot_pd(_mm256_castsi256_pd(cycled), active);
+				if (n + 1 == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+
+			if (_mm256_movemask_pd(active) == 0)
+			{
+				break;
+			}
+		}
+
+		_mm256_store_si256(reinterpret_cast<__m256i *>(counts), count);
+		const auto stored = std::min(lanes, row.count - i);
+		for (auto lane = 0; lane < stored; ++lane)
+		{
+			row.out[i + lane] = static_cast<std::uint32_t>(counts[lane]);
+		}
+	}
+}
+
+void juliaOrbitsAvx2(const JuliaOrbitsF & orbits)
+{
+	const auto escapeRadiusSquared = _mm256_set1_ps(orbits.escapeRadiusSquared);
+	const auto cRe = _mm256_set1_ps(orbits.constant.x);
+	const auto cIm = _mm256_set1_ps(orbits.constant.y);
+	const auto checkPeriod = orbits.periodEpsilon > 0.0f;
+	const auto epsilonSquared = _mm256_set1_ps(orbits.periodEpsilon * orbits.periodEpsilon);
+	const auto iterations = _mm256_set1_epi32(orbits.iterations);
+	const auto escaped = _mm256_set1_epi32(static_cast<int>(orbitEscaped));
+	const auto cycled = _mm256_set1_epi32(static_cast<int>(orbitCycled));
+
+	forOrbitLanes<8>(orbits, [&](const OrbitLanes & lanes) {
+		auto state = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes.state));
+		auto steps = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes.steps));
+		auto active = _mm256_and_si256(_mm256_cmpeq_epi32(state, _mm256_setzero_si256()), _mm256_cmpgt_epi32(iterations, steps));
+		if (_mm256_movemask_ps(_mm256_castsi256_ps(active)) == 0)
+		{
+			return;
+		}
+
+		auto x = _mm256_loadu_ps(lanes.x);
+		auto y = _mm256_loadu_ps(lanes.y);
+		auto savedX = _mm256_loadu_ps(lanes.savedX);
+		auto savedY = _mm256_loadu_ps(lanes.savedY);
+		auto nextSave = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes.nextSave));
+		while (_mm256_movemask_ps(_mm256_castsi256_ps(active)) != 0)
+		{
+			// Lanes that would escape keep the point before
+			const auto xx = _mm256_mul_ps(x, x);
+			const auto yy = _mm256_mul_ps(y, y);
+			const auto xy = _mm256_mul_ps(x, y);
+			const auto nextX = _mm256_add_ps(_mm256_sub_ps(xx, yy), cRe);
+			const auto nextY = _mm256_add_ps(_mm256_add_ps(xy, xy), cIm);
+			const auto magnitude = _mm256_add_ps(_mm256_mul_ps(nextX, nextX), _mm256_mul_ps(nextY, nextY));
+			const auto escaping = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(magnitude, escapeRadiusSquared, _CMP_GT_OQ)), active);
+			state = _mm256_blendv_epi8(state, escaped, escaping);
+			active = _mm256_andnot_si256(escaping, active);
+			x = _mm256_blendv_ps(x, nextX, _mm256_castsi256_ps(active));
+			y = _mm256_blendv_ps(y, nextY, _mm256_castsi256_ps(active));
+			// Active lanes are all ones, subtracting adds one.
+			steps = _mm256_sub_epi32(steps, active);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm256_sub_ps(x, savedX);
+				const auto dy = _mm256_sub_ps(y, savedY);
+				const auto distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+				const auto cycling = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(distance, epsilonSquared, _CMP_LT_OQ)), active);
+				state = _mm256_blendv_epi8(state, cycled, cycling);
+				active = _mm256_andnot_si256(cycling, active);
+				const auto saving = _mm256_and_si256(_mm256_cmpeq_epi32(steps, nextSave), active);
+				if (_mm256_movemask_ps(_mm256_castsi256_ps(saving)) != 0)
+				{
+					savedX = _mm256_blendv_ps(savedX, x, _mm256_castsi256_ps(saving));
+					savedY = _mm256_blendv_ps(savedY, y, _mm256_castsi256_ps(saving));
+					nextSave = _mm256_add_epi32(nextSave, _mm256_and_si256(nextSave, saving));
+				}
+			}
+
+			active = _mm256_and_si256(_mm256_cmpgt_epi32(iterations, steps), active);
+		}
+
+		_mm256_storeu_ps(lanes.x, x);
+		_mm256_storeu_ps(lanes.y, y);
+		_mm256_storeu_ps(lanes.savedX, savedX);
+		_mm256_storeu_ps(lanes.savedY, savedY);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes.steps), steps);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes.nextSave), nextSave);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes.state), state);
+	});
+}
+
+namespace
+{
+
+// Four lanes for the extended precision kernels.
+struct Pack
+{
+	struct Mask
+	{
+		__m256d v;
+	};
+
+	static constexpr int lanes = 4;
+
+	__m256d v;
+
+	static Pack broadcast(const double value) { return {_mm256_set1_pd(value)}; }
+	static Pack laneIndex() { return {_mm256_set_pd(3.0, 2.0, 1.0, 0.0)}; }
+	static Mask allLanes() { return {_mm256_castsi256_pd(_mm256_set1_epi32(-1))}; }
+};
+
+Pack operator+(const Pack a, const Pack b) { return {_mm256_add_pd(a.v, b.v)}; }
+Pack operator-(const Pack a, const Pack b) { return {_mm256_sub_pd(a.v, b.v)}; }
+Pack operator*(const Pack a, const Pack b) { return {_mm256_mul_pd(a.v, b.v)}; }
+Pack::Mask greater(const Pack a, const Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)}; }
+Pack::Mask less(const Pack a, const Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+Pack::Mask maskAnd(const Pack::Mask a, const Pack::Mask b) { return {_mm256_and_pd(a.v, b.v)}; }
+// b without the lanes of a.
+Pack::Mask maskAndNot(const Pack::Mask a, const Pack::Mask b) { return {_mm256_andnot_pd(a.v, b.v)}; }
+bool anyLane(const Pack::Mask mask) { return _mm256_movemask_pd(mask.v) != 0; }
+Pack select(const Pack::Mask mask, const Pack a, const Pack b) { return {_mm256_blendv_pd(b.v, a.v, mask.v)}; }
+void store(const Pack a, double * out) { _mm256_storeu_pd(out, a.v); }
+
+}// namespace
+
+void juliaRowAvx2(const JuliaRowDD & row) { extended::juliaRow<Pack>(row); }
+
+void juliaRowAvx2(const JuliaRowQD & row) { extended::juliaRow<Pack>(row); }
+
+}// namespace kernels
+}// namespace fgl
+
+#endif
@@ -0,0 +1,268 @@
+#include "JuliaKernelExtended.hpp"
+#include "JuliaKernelImpl.hpp"
+
+#if FGL_KERNELS_X86
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+namespace fgl
+{
+namespace kernels
+{
+
+// AVX-512 keeps the escape state in mask registers and only adds to the
+// iteration counters of lanes that are still active.
+
+void juliaRowAvx512(const JuliaRowF & row)
+{
+	constexpr auto lanes = 16;
+	const auto bailout = static_cast<float>(row.iterations);
+	const auto bailoutSquared = _mm512_set1_ps(bailout * bailout);
+	const auto cRe = _mm512_set1_ps(row.constant.x);
+	const auto cIm = _mm512_set1_ps(row.constant.y);
+	const auto laneOffsets = _mm512_set_ps(15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f,
+		7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+	const auto step = _mm512_set1_ps(row.step);
+	const auto checkPeriod = row.periodEpsilon > 0.0f;
+	const auto epsilonSquared = _mm512_set1_ps(row.periodEpsilon * row.periodEpsilon);
+	const auto cap = _mm512_set1_epi32(row.iterations);
+	const auto one = _mm512_set1_epi32(1);
+
+	alignas(64) std::uint32_t counts[lanes];
+	for (auto i = 0; i < row.count; i += lanes)
+	{
+		const auto index = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(row.first + i)), laneOffsets);
+		const auto along = _mm512_mul_ps(index, step);
+		auto x = row.column ? _mm512_set1_ps(row.start.x) : _mm512_add_ps(_mm512_set1_ps(row.start.x), along);
+		auto y = row.column ? _mm512_add_ps(_mm512_set1_ps(row.start.y), along) : _mm512_set1_ps(row.start.y);
+		__mmask16 active = 0xffff;
+		auto count = _mm512_setzero_si512();
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		for (auto n = 0; n < row.iterations; ++n)
+		{
+			count = _mm512_mask_add_epi32(count, active, count, one);
+			const auto xx = _mm512_mul_ps(x, x);
+			const auto yy = _mm512_mul_ps(y, y);
+			const auto xy = _mm512_mul_ps(x, y);
+			x = _mm512_add_ps(_mm512_sub_ps(xx, yy), cRe);
+			y = _mm512_add_ps(_mm512_add_ps(xy, xy), cIm);
+			const auto magnitude = _mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y));
+			active = _mm512_mask_cmp_ps_mask(active, magnitude, bailoutSquared, _CMP_NGT_UQ);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm512_sub_ps(x, savedX);
+				const auto dy = _mm512_sub_ps(y, savedY);
+				const auto distance = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy));
+				const auto cycled = _mm512_mask_cmp_ps_mask(active, distance, epsilonSquared, _CMP_LT_OQ);
+				// A cycle never escapes, its count jumps to the cap.
+				count = _mm512_mask_mov_epi32(count, cycled, cap);
+				active = static_cast<__mmask16>(active & ~cycled);
+				if (n + 1 == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+
+			if (active == 0)
+			{
+				break;
+			}
+		}
+
+		_mm512_store_si512(counts, count);
+		std::copy_n(counts, std::min(lanes, row.count - i), row.out + i);
+	}
+}
+
+void juliaRowAvx512(const JuliaRowD & row)
+{
+	constexpr auto lanes = 8;
+	const auto bailout = static_cast<double>(row.iterations);
+	const auto bailoutSquared = _mm512_set1_pd(bailout * bailout);
+	const auto cRe = _mm512_set1_pd(row.constant.x);
+	const auto cIm = _mm512_set1_pd(row.constant.y);
+	const auto laneOffsets = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+	const auto step = _mm512_set1_pd(row.step);
+	const auto checkPeriod = row.periodEpsilon > 0.0;
+	const auto epsilonSquared = _mm512_set1_pd(row.periodEpsilon * row.periodEpsilon);
+	const auto cap = _mm512_set1_epi64(row.iterations);
+	const auto one = _mm512_set1_epi64(1);
+
+	alignas(64) std::uint64_t counts[lanes];
+	for (auto i = 0; i < row.count; i += lanes)
+	{
+		const auto index = _mm512_add_pd(_mm512_set1_pd(static_cast<double>(row.first + i)), laneOffsets);
+		const auto along = _mm512_mul_pd(index, step);
+		auto x = row.column ? _mm512_set1_pd(row.start.x) : _mm512_add_pd(_mm512_set1_pd(row.start.x), along);
+		auto y = row.column ? _mm512_add_pd(_mm512_set1_pd(row.start.y), along) : _mm512_set1_pd(row.start.y);
+		__mmask8 active = 0xff;
+		auto count = _mm512_setzero_si512();
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		for (auto n = 0; n < row.iterations; ++n)
+		{
+			count = _mm512_mask_add_epi64(count, active, count, one);
+			const auto xx = _mm512_mul_pd(x, x);
+			const auto yy = _mm512_mul_pd(y, y);
+			const auto xy = _mm512_mul_pd(x, y);
+			x = _mm512_add_pd(_mm512_sub_pd(xx, yy), cRe);
+			y = _mm512_add_pd(_mm512_add_pd(xy, xy), cIm);
+			const auto magnitude = _mm512_add_pd(_mm512_mul_pd(x, x), _mm512_mul_pd(y, y));
+			active = _mm512_mask_cmp_pd_mask(active, magnitude, bailoutSquared, _CMP_NGT_UQ);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm512_sub_pd(x, savedX);
+				const auto dy = _mm512_sub_pd(y, savedY);
+				const auto distance = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+				const auto cycled = _mm512_mask_cmp_pd_mask(active, distance, epsilonSquared, _CMP_LT_OQ);
+				// A cycle never escapes, its count jumps to the cap.
+				count = _mm512_mask_mov_epi64(count, cycled, cap);
+				active = static_cast<__mmask8>(active & ~cycled);
+				if (n + 1 == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+
+			if (active == 0)
+			{
+				break;
+			}
+		}
+
+		_mm512_store_si512(counts, count);
+		const auto stored = std::min(lanes, row.count - i);
+		for (auto lane = 0; lane < stored; ++lane)
+		{
+			row.out[i + lane] = static_cast<std::uint32_t>(counts[lane]);
+		}
+	}
+}
+
+void juliaOrbitsAvx512(const JuliaOrbitsF & orbits)
+{
+	const auto escapeRadiusSquared = _mm512_set1_ps(orbits.escapeRadiusSquared);
+	const auto cRe = _mm512_set1_ps(orbits.constant.x);
+	const auto cIm = _mm512_set1_ps(orbits.constant.y);
+	const auto checkPeriod = orbits.periodEpsilon > 0.0f;
+	const auto epsilonSquared = _mm512_set1_ps(orbits.periodEpsilon * orbits.periodEpsilon);
+	const auto iterations = _mm512_set1_epi32(orbits.iterations);
+	const auto escaped = _mm512_set1_epi32(static_cast<int>(orbitEscaped));
+	const auto cycled = _mm512_set1_epi32(static_cast<int>(orbitCycled));
+	const auto one = _mm512_set1_epi32(1);
+
+	forOrbitLanes<16>(orbits, [&](const OrbitLanes & lanes) {
+		auto state = _mm512_loadu_si512(lanes.state);
+		auto steps = _mm512_loadu_si512(lanes.steps);
+		auto active = _mm512_mask_cmplt_epi32_mask(_mm512_cmpeq_epi32_mask(state, _mm512_setzero_si512()), steps, iterations);
+		if (active == 0)
+		{
+			return;
+		}
+
+		auto x = _mm512_loadu_ps(lanes.x);
+		auto y = _mm512_loadu_ps(lanes.y);
+		auto savedX = _mm512_loadu_ps(lanes.savedX);
+		auto savedY = _mm512_loadu_ps(lanes.savedY);
+		auto nextSave = _mm512_loadu_si512(lanes.nextSave);
+		while (active != 0)
+		{
+			// Lanes that would escape keep the point before
+			const auto xx = _mm512_mul_ps(x, x);
+			const auto yy = _mm512_mul_ps(y, y);
+			const auto xy = _mm512_mul_ps(x, y);
+			const auto nextX = _mm512_add_ps(_mm512_sub_ps(xx, yy), cRe);
+			const auto nextY = _mm512_add_ps(_mm512_add_ps(xy, xy), cIm);
+			const auto magnitude = _mm512_add_ps(_mm512_mul_ps(nextX, nextX), _mm512_mul_ps(nextY, nextY));
+			const auto escaping = _mm512_mask_cmp_ps_mask(active, magnitude, escapeRadiusSquared, _CMP_GT_OQ);
+			state = _mm512_mask_mov_epi32(state, escaping, escaped);
+			active = static_cast<__mmask16>(active & ~escaping);
+			x = _mm512_mask_mov_ps(x, active, nextX);
+			y = _mm512_mask_mov_ps(y, active, nextY);
+			steps = _mm512_mask_add_epi32(steps, active, steps, one);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm512_sub_ps(x, savedX);
+				const auto dy = _mm512_sub_ps(y, savedY);
+				const auto distance = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy));
+				const auto cycling = _mm512_mask_cmp_ps_mask(active, distance, epsilonSquared, _CMP_LT_OQ);
+				state = _mm512_mask_mov_epi32(state, cycling, cycled);
+				active = static_cast<__mmask16>(active & ~cycling);
+				const auto saving = _mm512_mask_cmpeq_epi32_mask(active, steps, nextSave);
+				if (saving != 0)
+				{
+					savedX = _mm512_mask_mov_ps(savedX, saving, x);
+					savedY = _mm512_mask_mov_ps(savedY, saving, y);
+					nextSave = _mm512_mask_add_epi32(nextSave, saving, nextSave, nextSave);
+				}
+			}
+
+			active = _mm512_mask_cmplt_epi32_mask(active, steps, iterations);
+		}
+
+		_mm512_storeu_ps(lanes.x, x);
+		_mm512_storeu_ps(lanes.y, y);
+		_mm512_storeu_ps(lanes.savedX, savedX);
+		_mm512_storeu_ps(lanes.savedY, savedY);
+		_mm512_storeu_si512(lanes.steps, steps);
+		_mm512_storeu_si512(lanes.nextSave, nextSave);
+		_mm512_storeu_si512(lanes.state, state);
+	});
+}
+
+namespace
+{
+
+// Eight lanes for the extended precision kernels, masks in mask registers.
+struct Pack
+{
+	struct Mask
+	{
+		__mmask8 v;
+	};
+
+	static constexpr int lanes = 8;
+
+	__m512d v;
+
+	static Pack broadcast(const double value) { return {_mm512_set1_pd(value)}; }
+	static Pack laneIndex() { return {_mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0)}; }
+	static Mask allLanes() { return {0xff}; }
+};
+
+Pack operator+(const Pack a, const Pack b) { return {_mm512_add_pd(a.v, b.v)}; }
+Pack operator-(const Pack a, const Pack b) { return {_mm512_sub_pd(a.v, b.v)}; }
+Pack operator*(const Pack a, const Pack b) { return {_mm512_mul_pd(a.v, b.v)}; }
+Pack::Mask greater(const Pack a, const Pack b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ)}; }
+Pack::Mask less(const Pack a, const Pack b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)}; }
+Pack::Mask maskAnd(const Pack::Mask a, const Pack::Mask b) { return {static_cast<__mmask8>(a.v & b.v)}; }
+// b without the lanes of a.
+Pack::Mask maskAndNot(const Pack::Mask a, const Pack::Mask b) { return {static_cast<__mmask8>(~a.v & b.v)}; }
+bool anyLane(const Pack::Mask mask) { return mask.v != 0; }
+Pack select(const Pack::Mask mask, const Pack a, const Pack b) { return {_mm512_mask_blend_pd(mask.v, b.v, a.v)}; }
+void store(const Pack a, double * out) { _mm512_storeu_pd(out, a.v); }
+
+}// namespace
+
+void juliaRowAvx512(const JuliaRowDD & row) { extended::juliaRow<Pack>(row); }
+
+void juliaRowAvx512(const JuliaRowQD & row) { extended::juliaRow<Pack>(row); }
+
+}// namespace kernels
+}// namespace fgl
+
+#endif
@@ -0,0 +1,316 @@
+#pragma once
+
+// Double-double and quad-double row kernels, written once against a pack of
+// double lanes. Only the kernel translation units should include this, each
+// instantiates it with its own pack type P, which provides
+//   P::lanes, P::Mask, P::broadcast(double), P::laneIndex(), P::allLanes(),
+//   + - * of two packs, greater(), less(), maskAnd(), maskAndNot(),
+//   anyLane(), select() and store().
+//
+// The error free transformations (Dekker, Knuth, Hida-Li-Bailey) need every
+// operation rounded as written, the kernel files are compiled without FMA
+// contraction. Without FMA every instruction set gives the same counts.
+
+#include <Core/JuliaKernel.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fgl
+{
+namespace kernels
+{
+namespace extended
+{
+
+// Lane wise unevaluated sum of Terms packs, largest first.
+template <typename P, std::size_t Terms>
+using Real = std::array<P, Terms>;
+
+// a + b == s + error exactly.
+template <typename P>
+P twoSum(const P a, const P b, P & error)
+{
+	const auto s = a + b;
+	const auto v = s - a;
+	error = (a - (s - v)) + (b - v);
+	return s;
+}
+
+// Same as twoSum() for |a| >= |b|.
+template <typename P>
+P quickTwoSum(const P a, const P b, P & error)
+{
+	const auto s = a + b;
+	error = b - (s - a);
+	return s;
+}
+
+// a * b == p + error exactly, splitting both into halves of 26 bits.
+template <typename P>
+P twoProduct(const P a, const P b, P & error)
+{
+	const auto splitter = P::broadcast(134217729.0);
+	const auto p = a * b;
+	const auto ta = splitter * a;
+	const auto aHigh = ta - (ta - a);
+	const auto aLow = a - aHigh;
+	const auto tb = splitter * b;
+	const auto bHigh = tb - (tb - b);
+	const auto bLow = b - bHigh;
+	error = ((aHigh * bHigh - p) + aHigh * bLow + aLow * bHigh) + aLow * bLow;
+	return p;
+}
+
+template <typename P, std::size_t Terms>
+Real<P, Terms> negate(const Real<P, Terms> & a)
+{
+	Real<P, Terms> result;
+	for (std::size_t i = 0; i < Terms; ++i)
+	{
+		result[i] = P::broadcast(0.0) - a[i];
+	}
+	return result;
+}
+
+// Exact, every term doubles.
+template <typename P, std::size_t Terms>
+Real<P, Terms> twice(const Real<P, Terms> & a)
+{
+	Real<P, Terms> result;
+	for (std::size_t i = 0; i < Terms; ++i)
+	{
+		result[i] = a[i] + a[i];
+	}
+	return result;
+}
+
+// Double-double
+
+template <typename P>
+Real<P, 2> add(const Real<P, 2> & a, const Real<P, 2> & b)
+{
+	P e;
+	P f;
+	auto s = twoSum(a[0], b[0], e);
+	const auto t = twoSum(a[1], b[1], f);
+	e = e + t;
+	s = quickTwoSum(s, e, e);
+	e = e + f;
+	s = quickTwoSum(s, e, e);
+	return {s, e};
+}
+
+template <typename P>
+Real<P, 2> add(const Real<P, 2> & a, const P b)
+{
+	P e;
+	const auto s = twoSum(a[0], b, e);
+	e = e + a[1];
+	return {quickTwoSum(s, e, e), e};
+}
+
+template <typename P>
+Real<P, 2> multiply(const Real<P, 2> & a, const Real<P, 2> & b)
+{
+	P e;
+	const auto p = twoProduct(a[0], b[0], e);
+	e = e + (a[0] * b[1] + a[1] * b[0]);
+	return {quickTwoSum(p, e, e), e};
+}
+
+// Quad-double
+
+// Branch free variant of the QD library renormalisation: a bottom up pass
+// of quick two sums, then a top down one. The library additionally skips
+// zero terms, which only matters after exact cancellation.
+template <typename P>
+Real<P, 4> renormalise(P c0, P c1, P c2, P c3, const P c4)
+{
+	P e;
+	auto s = quickTwoSum(c3, c4, c3);
+	s = quickTwoSum(c2, s, c2);
+	s = quickTwoSum(c1, s, c1);
+	c0 = quickTwoSum(c0, s, e);
+
+	Real<P, 4> result;
+	result[0] = c0;
+	result[1] = quickTwoSum(e, c1, e);
+	result[2] = quickTwoSum(e, c2, e);
+	result[3] = e + c3;
+	return result;
+}
+
+// (a, b, c) becomes (a + b + c, error, error of error).
+template <typename P>
+void threeSum(P & a, P & b, P & c)
+{
+	P t2;
+	P t3;
+	const auto t1 = twoSum(a, b, t2);
+	a = twoSum(c, t1, t3);
+	b = twoSum(t2, t3, c);
+}
+
+// Same as threeSum() but the last error is folded into b.
+template <typename P>
+void threeSumTwo(P & a, P & b, const P c)
+{
+	P t2;
+	P t3;
+	const auto t1 = twoSum(a, b, t2);
+	a = twoSum(c, t1, t3);
+	b = t2 + t3;
+}
+
+template <typename P>
+Real<P, 4> add(const Real<P, 4> & a, const Real<P, 4> & b)
+{
+	P t0;
+	P t1;
+	P t2;
+	P t3;
+	const auto s0 = twoSum(a[0], b[0], t0);
+	auto s1 = twoSum(a[1], b[1], t1);
+	auto s2 = twoSum(a[2], b[2], t2);
+	auto s3 = twoSum(a[3], b[3], t3);
+	s1 = twoSum(s1, t0, t0);
+	threeSum(s2, t0, t1);
+	threeSumTwo(s3, t0, t2);
+	t0 = t0 + t1 + t3;
+	return renormalise(s0, s1, s2, s3, t0);
+}
+
+template <typename P>
+Real<P, 4> add(const Real<P, 4> & a, const P b)
+{
+	P e;
+	const auto c0 = twoSum(a[0], b, e);
+	const auto c1 = twoSum(a[1], e, e);
+	const auto c2 = twoSum(a[2], e, e);
+	const auto c3 = twoSum(a[3], e, e);
+	return renormalise(c0, c1, c2, c3, e);
+}
+
+// Products of order 2^-212 and below are dropped, like the QD library's
+// sloppy multiplication.
+template <typename P>
+Real<P, 4> multiply(const Real<P, 4> & a, const Real<P, 4> & b)
+{
+	P q0;
+	P q1;
+	P q2;
+	P q3;
+	P q4;
+	P q5;
+	const auto p0 = twoProduct(a[0], b[0], q0);
+	auto p1 = twoProduct(a[0], b[1], q1);
+	auto p2 = twoProduct(a[1], b[0], q2);
+	auto p3 = twoProduct(a[0], b[2], q3);
+	auto p4 = twoProduct(a[1], b[1], q4);
+	auto p5 = twoProduct(a[2], b[0], q5);
+
+	threeSum(p1, p2, q0);
+	// Six-three sum of p2, q1, q2, p3, p4 and p5
+	threeSum(p2, q1, q2);
+	threeSum(p3, p4, p5);
+	P t0;
+	P t1;
+	const auto s0 = twoSum(p2, p3, t0);
+	auto s1 = twoSum(q1, p4, t1);
+	auto s2 = q2 + p5;
+	s1 = twoSum(s1, t0, t0);
+	s2 = s2 + (t0 + t1);
+
+	s1 = s1 + (a[0] * b[3] + a[1] * b[2] + a[2] * b[1] + a[3] * b[0] + q0 + q3 + q4 + q5);
+	return renormalise(p0, p1, s0, s1, s2);
+}
+
+template <typename P, std::size_t Terms>
+Real<P, Terms> broadcast(const std::array<double, Terms> & value)
+{
+	Real<P, Terms> result;
+	for (std::size_t i = 0; i < Terms; ++i)
+	{
+		result[i] = P::broadcast(value[i]);
+	}
+	return result;
+}
+
+template <typename P, int Terms>
+void juliaRow(const JuliaRowExtended<Terms> & row)
+{
+	constexpr auto lanes = P::lanes;
+	const auto bailout = static_cast<double>(row.iterations);
+	const auto bailoutSquared = P::broadcast(bailout * bailout);
+	const auto constantX = P::broadcast(row.constant.x);
+	const auto constantY = P::broadcast(row.constant.y);
+	const auto centreX = broadcast<P>(row.centreX);
+	const auto centreY = broadcast<P>(row.centreY);
+	const auto step = P::broadcast(row.step);
+	const auto checkPeriod = row.periodEpsilon > 0.0;
+	const auto epsilonSquared = P::broadcast(row.periodEpsilon * row.periodEpsilon);
+	const auto zero = P::broadcast(0.0);
+	const auto one = P::broadcast(1.0);
+	const auto cap = P::broadcast(bailout);
+
+	// Counts stay exact in doubles far beyond any iteration cap.
+	std::array<double, lanes> counts;
+	for (auto i = 0; i < row.count; i += lanes)
+	{
+		const auto along = (P::broadcast(static_cast<double>(row.first + i)) + P::laneIndex()) * step;
+		auto x = add(centreX, row.column ? P::broadcast(row.offset.x) : P::broadcast(row.offset.x) + along);
+		auto y = add(centreY, row.column ? P::broadcast(row.offset.y) + along : P::broadcast(row.offset.y));
+		auto active = P::allLanes();
+		auto count = zero;
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		for (auto n = 0; n < row.iterations; ++n)
+		{
+			count = count + select(active, one, zero);
+			// (x + y)(x - y) takes one product less than x^2 - y^2
+			const auto xy = multiply(x, y);
+			x = add(multiply(add(x, y), add(x, negate(y))), constantX);
+			y = add(twice(xy), constantY);
+			const auto magnitude = x[0] * x[0] + y[0] * y[0];
+			active = maskAndNot(greater(magnitude, bailoutSquared), active);
+
+			if (checkPeriod)
+			{
+				// The leading terms alone cannot tell points a pixel apart
+				const auto dx = add(x, negate(savedX))[0];
+				const auto dy = add(y, negate(savedY))[0];
+				const auto cycled = maskAnd(less(dx * dx + dy * dy, epsilonSquared), active);
+				// A cycle never escapes, its count jumps to the cap.
+				count = select(cycled, cap, count);
+				active = maskAndNot(cycled, active);
+				if (n + 1 == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+
+			if (!anyLane(active))
+			{
+				break;
+			}
+		}
+
+		store(count, counts.data());
+		const auto stored = std::min(lanes, row.count - i);
+		for (auto lane = 0; lane < stored; ++lane)
+		{
+			row.out[i + lane] = static_cast<std::uint32_t>(counts[static_cast<std::size_t>(lane)]);
+		}
+	}
+}
+
+}// namespace extended
+}// namespace kernels
+}// namespace fgl
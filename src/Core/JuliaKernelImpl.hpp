@@ -0,0 +1,101 @@
+#pragma once
+
+// Row kernels for every instruction set, only JuliaKernel.cpp should use them.
+
+#include <Core/JuliaKernel.hpp>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FGL_KERNELS_X86 1
+#else
+#define FGL_KERNELS_X86 0
+#endif
+
+namespace fgl
+{
+namespace kernels
+{
+
+// Orbit state of Lanes consecutive points of a JuliaOrbitsF.
+struct OrbitLanes
+{
+	float * x;
+	float * y;
+	float * savedX;
+	float * savedY;
+	std::uint32_t * steps;
+	std::uint32_t * nextSave;
+	std::uint32_t * state;
+};
+
+// Calls block for every Lanes points, the last ones are copied to a full
+// set of lanes padded with escaped points.
+template <int Lanes, typename Block>
+void forOrbitLanes(const JuliaOrbitsF & orbits, const Block & block)
+{
+	auto i = 0;
+	for (; i + Lanes <= orbits.count; i += Lanes)
+	{
+		block(OrbitLanes{orbits.x + i, orbits.y + i, orbits.savedX + i, orbits.savedY + i, orbits.steps + i,
+						 orbits.nextSave + i, orbits.state + i});
+	}
+	const auto rest = orbits.count - i;
+	if (rest == 0)
+	{
+		return;
+	}
+
+	alignas(64) float x[Lanes] = {};
+	alignas(64) float y[Lanes] = {};
+	alignas(64) float savedX[Lanes] = {};
+	alignas(64) float savedY[Lanes] = {};
+	alignas(64) std::uint32_t steps[Lanes] = {};
+	alignas(64) std::uint32_t nextSave[Lanes] = {};
+	alignas(64) std::uint32_t state[Lanes];
+	std::fill_n(state, Lanes, orbitEscaped);
+	const OrbitLanes copies{x, y, savedX, savedY, steps, nextSave, state};
+	const OrbitLanes tail{orbits.x + i, orbits.y + i, orbits.savedX + i, orbits.savedY + i, orbits.steps + i,
+						  orbits.nextSave + i, orbits.state + i};
+	const auto copy = [rest](const OrbitLanes & from, const OrbitLanes & to) {
+		std::copy_n(from.x, rest, to.x);
+		std::copy_n(from.y, rest, to.y);
+		std::copy_n(from.savedX, rest, to.savedX);
+		std::copy_n(from.savedY, rest, to.savedY);
+		std::copy_n(from.steps, rest, to.steps);
+		std::copy_n(from.nextSave, rest, to.nextSave);
+		std::copy_n(from.state, rest, to.state);
+	};
+	copy(tail, copies);
+	block(copies);
+	copy(copies, tail);
+}
+
+void juliaRowScalar(const JuliaRowF & row);
+void juliaRowScalar(const JuliaRowD & row);
+void juliaRowScalar(const JuliaRowDD & row);
+void juliaRowScalar(const JuliaRowQD & row);
+void juliaOrbitsScalar(const JuliaOrbitsF & orbits);
+
+#if FGL_KERNELS_X86
+void juliaRowSse2(const JuliaRowF & row);
+void juliaRowSse2(const JuliaRowD & row);
+void juliaRowSse2(const JuliaRowDD & row);
+void juliaRowSse2(const JuliaRowQD & row);
+void juliaOrbitsSse2(const JuliaOrbitsF & orbits);
+
+void juliaRowAvx2(const JuliaRowF & row);
+void juliaRowAvx2(const JuliaRowD & row);
+void juliaRowAvx2(const JuliaRowDD & row);
+void juliaRowAvx2(const JuliaRowQD & row);
+void juliaOrbitsAvx2(const JuliaOrbitsF & orbits);
+
+void juliaRowAvx512(const JuliaRowF & row);
+void juliaRowAvx512(const JuliaRowD & row);
+void juliaRowAvx512(const JuliaRowDD & row);
+void juliaRowAvx512(const JuliaRowQD & row);
+void juliaOrbitsAvx512(const JuliaOrbitsF & orbits);
+#endif
+
+}// namespace kernels
+}// namespace fgl
@@ -0,0 +1,166 @@
+#include "JuliaKernelExtended.hpp"
+#include "JuliaKernelImpl.hpp"
+
+namespace fgl
+{
+namespace kernels
+{
+
+namespace
+{
+
+template <typename T>
+void juliaRow(const JuliaRow<T> & row)
+{
+	const auto bailout = static_cast<T>(row.iterations);
+	const auto bailoutSquared = bailout * bailout;
+	const auto checkPeriod = row.periodEpsilon > 0;
+	const auto epsilonSquared = row.periodEpsilon * row.periodEpsilon;
+
+	for (auto i = 0; i < row.count; ++i)
+	{
+		const auto along = static_cast<T>(row.first + i) * row.step;
+		auto x = row.column ? row.start.x : row.start.x + along;
+		auto y = row.column ? row.start.y + along : row.start.y;
+
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		auto count = 0;
+		while (count < row.iterations)
+		{
+			++count;
+			const auto xx = x * x;
+			const auto yy = y * y;
+			const auto xy = x * y;
+			x = xx - yy + row.constant.x;
+			y = xy + xy + row.constant.y;
+			if (x * x + y * y > bailoutSquared)
+			{
+				break;
+			}
+
+			if (checkPeriod)
+			{
+				const auto dx = x - savedX;
+				const auto dy = y - savedY;
+				if (dx * dx + dy * dy < epsilonSquared)
+				{
+					count = row.iterations;
+					break;
+				}
+				if (count == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+		}
+		row.out[i] = static_cast<std::uint32_t>(count);
+	}
+}
+
+// One lane for the extended precision kernels.
+struct Pack
+{
+	struct Mask
+	{
+		bool v;
+	};
+
+	static constexpr int lanes = 1;
+
+	double v;
+
+	static Pack broadcast(const double value) { return {value}; }
+	static Pack laneIndex() { return {0.0}; }
+	static Mask allLanes() { return {true}; }
+};
+
+Pack operator+(const Pack a, const Pack b) { return {a.v + b.v}; }
+Pack operator-(const Pack a, const Pack b) { return {a.v - b.v}; }
+Pack operator*(const Pack a, const Pack b) { return {a.v * b.v}; }
+Pack::Mask greater(const Pack a, const Pack b) { return {a.v > b.v}; }
+Pack::Mask less(const Pack a, const Pack b) { return {a.v < b.v}; }
+Pack::Mask maskAnd(const Pack::Mask a, const Pack::Mask b) { return {a.v && b.v}; }
+// b without the lanes of a.
+Pack::Mask maskAndNot(const Pack::Mask a, const Pack::Mask b) { return {!a.v && b.v}; }
+bool anyLane(const Pack::Mask mask) { return mask.v; }
+Pack select(const Pack::Mask mask, const Pack a, const Pack b) { return mask.v ? a : b; }
+void store(const Pack a, double * out) { *out = a.v; }
+
+}// namespace
+
+void juliaRowScalar(const JuliaRowF & row) { juliaRow(row); }
+
+void juliaRowScalar(const JuliaRowD & row) { juliaRow(row); }
+
+void juliaRowScalar(const JuliaRowDD & row) { extended::juliaRow<Pack>(row); }
+
+void juliaRowScalar(const JuliaRowQD & row) { extended::juliaRow<Pack>(row); }
+
+void juliaOrbitsScalar(const JuliaOrbitsF & orbits)
+{
+	const auto checkPeriod = orbits.periodEpsilon > 0.0f;
+	const auto epsilonSquared = orbits.periodEpsilon * orbits.periodEpsilon;
+	const auto iterations = static_cast<std::uint32_t>(orbits.iterations);
+
+	for (auto i = 0; i < orbits.count; ++i)
+	{
+		if (orbits.state[i] != orbitIterating)
+		{
+			continue;
+		}
+
+		auto x = orbits.x[i];
+		auto y = orbits.y[i];
+		auto savedX = orbits.savedX[i];
+		auto savedY = orbits.savedY[i];
+		auto steps = orbits.steps[i];
+		auto nextSave = orbits.nextSave[i];
+		while (steps < iterations)
+		{
+			const auto xx = x * x;
+			const auto yy = y * y;
+			const auto xy = x * y;
+			const auto nextX = xx - yy + orbits.constant.x;
+			const auto nextY = xy + xy + orbits.constant.y;
+			if (nextX * nextX + nextY * nextY > orbits.escapeRadiusSquared)
+			{
+				orbits.state[i] = orbitEscaped;
+				break;
+			}
+			x = nextX;
+			y = nextY;
+			++steps;
+
+			if (checkPeriod)
+			{
+				const auto dx = x - savedX;
+				const auto dy = y - savedY;
+				if (dx * dx + dy * dy < epsilonSquared)
+				{
+					orbits.state[i] = orbitCycled;
+					break;
+				}
+				if (steps == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+		}
+		orbits.x[i] = x;
+		orbits.y[i] = y;
+		orbits.savedX[i] = savedX;
+		orbits.savedY[i] = savedY;
+		orbits.steps[i] = steps;
+		orbits.nextSave[i] = nextSave;
+	}
+}
+
+}// namespace kernels
+}// namespace fgl
@@ -0,0 +1,278 @@
+#include "JuliaKernelExtended.hpp"
+#include "JuliaKernelImpl.hpp"
+
+#if FGL_KERNELS_X86
+
+#include <emmintrin.h>
+
+#include <algorithm>
+
+namespace fgl
+{
+namespace kernels
+{
+
+// Escaped lanes stay in the loop with a cleared mask, only active lanes
+// count iterations. The loop ends once every lane has escaped.
+
+void juliaRowSse2(const JuliaRowF & row)
+{
+	constexpr auto lanes = 4;
+	const auto bailout = static_cast<float>(row.iterations);
+	const auto bailoutSquared = _mm_set1_ps(bailout * bailout);
+	const auto cRe = _mm_set1_ps(row.constant.x);
+	const auto cIm = _mm_set1_ps(row.constant.y);
+	const auto laneOffsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	const auto step = _mm_set1_ps(row.step);
+	const auto checkPeriod = row.periodEpsilon > 0.0f;
+	const auto epsilonSquared = _mm_set1_ps(row.periodEpsilon * row.periodEpsilon);
+	const auto cap = _mm_set1_epi32(row.iterations);
+
+	alignas(16) std::uint32_t counts[lanes];
+	for (auto i = 0; i < row.count; i += lanes)
+	{
+		const auto index = _mm_add_ps(_mm_set1_ps(static_cast<float>(row.first + i)), laneOffsets);
+		const auto along = _mm_mul_ps(index, step);
+		auto x = row.column ? _mm_set1_ps(row.start.x) : _mm_add_ps(_mm_set1_ps(row.start.x), along);
+		auto y = row.column ? _mm_add_ps(_mm_set1_ps(row.start.y), along) : _mm_set1_ps(row.start.y);
+		auto active = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		auto count = _mm_setzero_si128();
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		for (auto n = 0; n < row.iterations; ++n)
+		{
+			// Active lanes are all ones, subtracting adds one.
+			count = _mm_sub_epi32(count, _mm_castps_si128(active));
+			const auto xx = _mm_mul_ps(x, x);
+			const auto yy = _mm_mul_ps(y, y);
+			const auto xy = _mm_mul_ps(x, y);
+			x = _mm_add_ps(_mm_sub_ps(xx, yy), cRe);
+			y = _mm_add_ps(_mm_add_ps(xy, xy), cIm);
+			const auto magnitude = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+			active = _mm_andnot_ps(_mm_cmpgt_ps(magnitude, bailoutSquared), active);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm_sub_ps(x, savedX);
+				const auto dy = _mm_sub_ps(y, savedY);
+				const auto distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+				const auto cycled = _mm_castps_si128(_mm_and_ps(_mm_cmplt_ps(distance, epsilonSquared), active));
+				// A cycle never escapes, its count jumps to the cap.
+				count = _mm_or_si128(_mm_andnot_si128(cycled, count), _mm_and_si128(cycled, cap));
+				active = _mm_andnot_ps(_mm_castsi128_ps(cycled), active);
+				if (n + 1 == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+
+			if (_mm_movemask_ps(active) == 0)
+			{
+				break;
+			}
+		}
+
+		_mm_store_si128(reinterpret_cast<__m128i *>(counts), count);
+		std::copy_n(counts, std::min(lanes, row.count - i), row.out + i);
+	}
+}
+
+void juliaRowSse2(const JuliaRowD & row)
+{
+	constexpr auto lanes = 2;
+	const auto bailout = static_cast<double>(row.iterations);
+	const auto bailoutSquared = _mm_set1_pd(bailout * bailout);
+	const auto cRe = _mm_set1_pd(row.constant.x);
+	const auto cIm = _mm_set1_pd(row.constant.y);
+	const auto laneOffsets = _mm_set_pd(1.0, 0.0);
+	const auto step = _mm_set1_pd(row.step);
+	const auto checkPeriod = row.periodEpsilon > 0.0;
+	const auto epsilonSquared = _mm_set1_pd(row.periodEpsilon * row.periodEpsilon);
+	const auto cap = _mm_set1_epi64x(row.iterations);
+
+	alignas(16) std::uint64_t counts[lanes];
+	for (auto i = 0; i < row.count; i += lanes)
+	{
+		const auto index = _mm_add_pd(_mm_set1_pd(static_cast<double>(row.first + i)), laneOffsets);
+		const auto along = _mm_mul_pd(index, step);
+		auto x = row.column ? _mm_set1_pd(row.start.x) : _mm_add_pd(_mm_set1_pd(row.start.x), along);
+		auto y = row.column ? _mm_add_pd(_mm_set1_pd(row.start.y), along) : _mm_set1_pd(row.start.y);
+		auto active = _mm_castsi128_pd(_mm_set1_epi32(-1));
+		auto count = _mm_setzero_si128();
+		auto savedX = x;
+		auto savedY = y;
+		auto nextSave = 1;
+
+		for (auto n = 0; n < row.iterations; ++n)
+		{
+			count = _mm_sub_epi64(count, _mm_castpd_si128(active));
+			const auto xx = _mm_mul_pd(x, x);
+			const auto yy = _mm_mul_pd(y, y);
+			const auto xy = _mm_mul_pd(x, y);
+			x = _mm_add_pd(_mm_sub_pd(xx, yy), cRe);
+			y = _mm_add_pd(_mm_add_pd(xy, xy), cIm);
+			const auto magnitude = _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y));
+			active = _mm_andnot_pd(_mm_cmpgt_pd(magnitude, bailoutSquared), active);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm_sub_pd(x, savedX);
+				const auto dy = _mm_sub_pd(y, savedY);
+				const auto distance = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+				const auto cycled = _mm_castpd_si128(_mm_and_pd(_mm_cmplt_pd(distance, epsilonSquared), active));
+				// A cycle never escapes, its count jumps to the cap.
+				count = _mm_or_si128(_mm_andnot_si128(cycled, count), _mm_and_si128(cycled, cap));
+				active = _mm_andnot_pd(_mm_castsi128_pd(cycled), active);
+				if (n + 1 == nextSave)
+				{
+					savedX = x;
+					savedY = y;
+					nextSave *= 2;
+				}
+			}
+
+			if (_mm_movemask_pd(active) == 0)
+			{
+				break;
+			}
+		}
+
+		_mm_store_si128(reinterpret_cast<__m128i *>(counts), count);
+		const auto stored = std::min(lanes, row.count - i);
+		for (auto lane = 0; lane < stored; ++lane)
+		{
+			row.out[i + lane] = static_cast<std::uint32_t>(counts[lane]);
+		}
+	}
+}
+
+namespace
+{
+
+// a where the mask is set, b elsewhere, SSE2 has no blend.
+__m128 selectPs(const __m128 mask, const __m128 a, const __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+__m128i selectEpi32(const __m128i mask, const __m128i a, const __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+}// namespace
+
+void juliaOrbitsSse2(const JuliaOrbitsF & orbits)
+{
+	const auto escapeRadiusSquared = _mm_set1_ps(orbits.escapeRadiusSquared);
+	const auto cRe = _mm_set1_ps(orbits.constant.x);
+	const auto cIm = _mm_set1_ps(orbits.constant.y);
+	const auto checkPeriod = orbits.periodEpsilon > 0.0f;
+	const auto epsilonSquared = _mm_set1_ps(orbits.periodEpsilon * orbits.periodEpsilon);
+	const auto iterations = _mm_set1_epi32(orbits.iterations);
+	const auto escaped = _mm_set1_epi32(static_cast<int>(orbitEscaped));
+	const auto cycled = _mm_set1_epi32(static_cast<int>(orbitCycled));
+
+	forOrbitLanes<4>(orbits, [&](const OrbitLanes & lanes) {
+		auto state = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes.state));
+		auto steps = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes.steps));
+		auto active = _mm_and_si128(_mm_cmpeq_epi32(state, _mm_setzero_si128()), _mm_cmpgt_epi32(iterations, steps));
+		if (_mm_movemask_ps(_mm_castsi128_ps(active)) == 0)
+		{
+			return;
+		}
+
+		auto x = _mm_loadu_ps(lanes.x);
+		auto y = _mm_loadu_ps(lanes.y);
+		auto savedX = _mm_loadu_ps(lanes.savedX);
+		auto savedY = _mm_loadu_ps(lanes.savedY);
+		auto nextSave = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes.nextSave));
+		while (_mm_movemask_ps(_mm_castsi128_ps(active)) != 0)
+		{
+			// Lanes that would escape keep the point before
+			const auto xx = _mm_mul_ps(x, x);
+			const auto yy = _mm_mul_ps(y, y);
+			const auto xy = _mm_mul_ps(x, y);
+			const auto nextX = _mm_add_ps(_mm_sub_ps(xx, yy), cRe);
+			const auto nextY = _mm_add_ps(_mm_add_ps(xy, xy), cIm);
+			const auto magnitude = _mm_add_ps(_mm_mul_ps(nextX, nextX), _mm_mul_ps(nextY, nextY));
+			const auto escaping = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(magnitude, escapeRadiusSquared)), active);
+			state = selectEpi32(escaping, escaped, state);
+			active = _mm_andnot_si128(escaping, active);
+			x = selectPs(_mm_castsi128_ps(active), nextX, x);
+			y = selectPs(_mm_castsi128_ps(active), nextY, y);
+			// Active lanes are all ones, subtracting adds one.
+			steps = _mm_sub_epi32(steps, active);
+
+			if (checkPeriod)
+			{
+				const auto dx = _mm_sub_ps(x, savedX);
+				const auto dy = _mm_sub_ps(y, savedY);
+				const auto distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+				const auto cycling = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(distance, epsilonSquared)), active);
+				state = selectEpi32(cycling, cycled, state);
+				active = _mm_andnot_si128(cycling, active);
+				const auto saving = _mm_and_si128(_mm_cmpeq_epi32(steps, nextSave), active);
+				if (_mm_movemask_ps(_mm_castsi128_ps(saving)) != 0)
+				{
+					savedX = selectPs(_mm_castsi128_ps(saving), x, savedX);
+					savedY = selectPs(_mm_castsi128_ps(saving), y, savedY);
+					nextSave = _mm_add_epi32(nextSave, _mm_and_si128(nextSave, saving));
+				}
+			}
+
+			active = _mm_and_si128(_mm_cmpgt_epi32(iterations, steps), active);
+		}
+
+		_mm_storeu_ps(lanes.x, x);
+		_mm_storeu_ps(lanes.y, y);
+		_mm_storeu_ps(lanes.savedX, savedX);
+		_mm_storeu_ps(lanes.savedY, savedY);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(lanes.steps), steps);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(lanes.nextSave), nextSave);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(lanes.state), state);
+	});
+}
+
+namespace
+{
+
+// Two lanes for the extended precision kernels.
+struct Pack
+{
+	struct Mask
+	{
+		__m128d v;
+	};
+
+	static constexpr int lanes = 2;
+
+	__m128d v;
+
+	static Pack broadcast(const double value) { return {_mm_set1_pd(value)}; }
+	static Pack laneIndex() { return {_mm_set_pd(1.0, 0.0)}; }
+	static Mask allLanes() { return {_mm_castsi128_pd(_mm_set1_epi32(-1))}; }
+};
+
+Pack operator+(const Pack a, const Pack b) { return {_mm_add_pd(a.v, b.v)}; }
+Pack operator-(const Pack a, const Pack b) { return {_mm_sub_pd(a.v, b.v)}; }
+Pack operator*(const Pack a, const Pack b) { return {_mm_mul_pd(a.v, b.v)}; }
+Pack::Mask greater(const Pack a, const Pack b) { return {_mm_cmpgt_pd(a.v, b.v)}; }
+Pack::Mask less(const Pack a, const Pack b) { return {_mm_cmplt_pd(a.v, b.v)}; }
+Pack::Mask maskAnd(const Pack::Mask a, const Pack::Mask b) { return {_mm_and_pd(a.v, b.v)}; }
+// b without the lanes of a.
+Pack::Mask maskAndNot(const Pack::Mask a, const Pack::Mask b) { return {_mm_andnot_pd(a.v, b.v)}; }
+bool anyLane(const Pack::Mask mask) { return _mm_movemask_pd(mask.v) != 0; }
+Pack select(const Pack::Mask mask, const Pack a, const Pack b) { return {_mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v))}; }
+void store(const Pack a, double * out) { _mm_storeu_pd(out, a.v); }
+
+}// namespace
+
+void juliaRowSse2(const JuliaRowDD & row) { extended::juliaRow<Pack>(row); }
+
+void juliaRowSse2(const JuliaRowQD & row) { extended::juliaRow<Pack>(row); }
+
+}// namespace kernels
+}// namespace fgl
+
+#endif
@@ -0,0 +1,283 @@
+#include "JuliaRenderer.hpp"
+
+#include "DeepZoom.hpp"
+#include "Subdivision.hpp"
+#include "Symmetry.hpp"
+#include "TilePool.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace fgl
+{
+
+namespace
+{
+
+std::size_t pixelCount(const Viewport & viewport)
+{
+	return static_cast<std::size_t>(viewport.width) * static_cast<std::size_t>(viewport.height);
+}
+
+template <typename View>
+void renderTiles(const View & viewport, const Rect & region, gsl::span<std::uint32_t> iterations, const RenderOptions & options)
+{
+	const auto tileSize = options.tileSize;
+	const auto columns = (region.width + tileSize - 1) / tileSize;
+	const auto rows = (region.height + tileSize - 1) / tileSize;
+	if (columns <= 0 || rows <= 0)
+	{
+		return;
+	}
+
+	auto tileOptions = options;
+	tileOptions.pool = nullptr;
+	options.pool->run(static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows), [&](const std::size_t index) {
+		const auto column = static_cast<int>(index % static_cast<std::size_t>(columns));
+		const auto row = static_cast<int>(index / static_cast<std::size_t>(columns));
+		Rect tile;
+		tile.x = region.x + column * tileSize;
+		tile.y = region.y + row * tileSize;
+		tile.width = std::min(tileSize, region.x + region.width - tile.x);
+		tile.height = std::min(tileSize, region.y + region.height - tile.y);
+		renderJulia(viewport, tile, iterations, tileOptions);
+	});
+}
+
+bool isExtended(const Precision precision)
+{
+	return precision == Precision::DoubleDouble || precision == Precision::QuadDouble;
+}
+
+// Leading Terms doubles of value, each one the remainder of those before.
+template <int Terms>
+std::array<double, Terms> splitTerms(DeepReal value)
+{
+	std::array<double, Terms> terms{};
+	for (auto & term : terms)
+	{
+		term = value.toDouble();
+		value -= DeepReal{term};
+	}
+	return terms;
+}
+
+template <int Terms>
+void renderExtendedRows(const DeepViewport & viewport, const Rect & region, gsl::span<std::uint32_t> iterations,
+						void (*rowKernel)(const JuliaRowExtended<Terms> &), const double periodEpsilon)
+{
+	const auto & view = viewport.view;
+	JuliaRowExtended<Terms> row;
+	row.centreX = splitTerms<Terms>(viewport.centreX);
+	row.centreY = splitTerms<Terms>(viewport.centreY);
+	row.first = region.x;
+	row.step = view.pixelSpacingX();
+	row.constant = {view.constantRe(), view.constantIm()};
+	row.iterations = view.iterations;
+	row.periodEpsilon = periodEpsilon;
+	row.count = region.width;
+	for (auto y = region.y; y < region.y + region.height; ++y)
+	{
+		// Offsets from the centre are small enough for a double
+		row.offset = {view.planeX(0), view.planeY(y)};
+		row.out = iterations.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(view.width) + region.x;
+		rowKernel(row);
+	}
+}
+
+}// namespace
+
+std::uint32_t juliaIterations(float x, float y, const float cRe, const float cIm, const int iterations)
+{
+	// Compare squared magnitudes instead of calling length() every step.
+	const auto bailout = static_cast<float>(iterations);
+	const auto bailoutSquared = bailout * bailout;
+
+	auto count = 0;
+	while (count < iterations)
+	{
+		++count;
+		const auto xx = x * x;
+		const auto yy = y * y;
+		y = 2.0f * x * y + cIm;
+		x = xx - yy + cRe;
+		if (x * x + y * y > bailoutSquared)
+		{
+			break;
+		}
+	}
+	return static_cast<std::uint32_t>(count);
+}
+
+void renderJulia(const Viewport & viewport, gsl::span<std::uint32_t> iterations, const RenderOptions & options)
+{
+	const auto symmetry = options.symmetry ? findSymmetry(viewport) : std::nullopt;
+	if (!symmetry)
+	{
+		renderJulia(viewport, viewport.bounds(), iterations, options);
+		return;
+	}
+
+	for (const auto & region : symmetricRegions(viewport, *symmetry))
+	{
+		renderJulia(viewport, region, iterations, options);
+	}
+	mirrorBuffer(iterations, viewport.width, *symmetry);
+}
+
+void renderJulia(const Viewport & viewport, const Rect & region, gsl::span<std::uint32_t> iterations, const RenderOptions & options)
+{
+	Expects(iterations.size() >= pixelCount(viewport));
+	Expects(region.x >= 0 && region.y >= 0);
+	Expects(region.x + region.width <= viewport.width && region.y + region.height <= viewport.height);
+
+	if (isExtended(options.precision))
+	{
+		// Same counts as the deep view of the rounded centre
+		renderJulia(deepViewport(viewport), region, iterations, options);
+		return;
+	}
+
+	if (options.subdivide)
+	{
+		renderSubdivided(viewport, region, iterations, options);
+		return;
+	}
+
+	if (options.pool && options.tileSize > 0)
+	{
+		renderTiles(viewport, region, iterations, options);
+		return;
+	}
+
+	const auto & kernel = options.kernel ? *options.kernel : bestJuliaKernel();
+	const auto periodEpsilon = options.periodicityTolerance * viewport.pixelSpacingX();
+	for (auto y = region.y; y < region.y + region.height; ++y)
+	{
+		auto * out = iterations.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(viewport.width) + region.x;
+		if (options.precision == Precision::Double)
+		{
+			JuliaRowD row;
+			row.start = {viewport.planeX(0), viewport.planeY(y)};
+			row.first = region.x;
+			row.step = viewport.pixelSpacingX();
+			row.constant = {viewport.constantRe(), viewport.constantIm()};
+			row.iterations = viewport.iterations;
+			row.periodEpsilon = periodEpsilon;
+			row.count = region.width;
+			row.out = out;
+			kernel.rowDouble(row);
+		}
+		else
+		{
+			JuliaRowF row;
+			row.start = {static_cast<float>(viewport.planeX(0)), static_cast<float>(viewport.planeY(y))};
+			row.first = region.x;
+			row.step = static_cast<float>(viewport.pixelSpacingX());
+			row.constant = {viewport.constantRe(), viewport.constantIm()};
+			row.iterations = viewport.iterations;
+			row.periodEpsilon = static_cast<float>(periodEpsilon);
+			row.count = region.width;
+			row.out = out;
+			kernel.rowFloat(row);
+		}
+	}
+}
+
+void renderJulia(const DeepViewport & viewport, gsl::span<std::uint32_t> iterations, const RenderOptions & options)
+{
+	renderJulia(viewport, viewport.view.bounds(), iterations, options);
+}
+
+void renderJulia(const DeepViewport & viewport, const Rect & region, gsl::span<std::uint32_t> iterations, const RenderOptions & options)
+{
+	const auto & view = viewport.view;
+	Expects(iterations.size() >= pixelCount(view));
+	Expects(region.x >= 0 && region.y >= 0);
+	Expects(region.x + region.width <= view.width && region.y + region.height <= view.height);
+	Expects(view.shiftX == 0.0 && view.shiftY == 0.0);
+
+	if (!isExtended(options.precision))
+	{
+		auto rounded = view;
+		rounded.shiftX = viewport.centreX.toDouble() * view.zoom;
+		rounded.shiftY = viewport.centreY.toDouble() * view.zoom;
+		renderJulia(rounded, region, iterations, options);
+		return;
+	}
+
+	if (options.pool && options.tileSize > 0)
+	{
+		renderTiles(viewport, region, iterations, options);
+		return;
+	}
+
+	const auto & kernel = options.kernel ? *options.kernel : bestJuliaKernel();
+	const auto periodEpsilon = options.periodicityTolerance * view.pixelSpacingX();
+	if (options.precision == Precision::DoubleDouble)
+	{
+		renderExtendedRows(viewport, region, iterations, kernel.rowDoubleDouble, periodEpsilon);
+	}
+	else
+	{
+		renderExtendedRows(viewport, region, iterations, kernel.rowQuadDouble, periodEpsilon);
+	}
+}
+
+void renderJuliaColumn(const Viewport & viewport, const int x, const int y, const int count, gsl::span<std::uint32_t> iterations,
+					   const RenderOptions & options)
+{
+	Expects(iterations.size() >= pixelCount(viewport));
+	Expects(!isExtended(options.precision));
+	Expects(x >= 0 && x < viewport.width && y >= 0 && y + count <= viewport.height);
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// Kernels write contiguously, scatter into the column afterwards.
+	thread_local std::vector<std::uint32_t> column;
+	column.resize(static_cast<std::size_t>(count));
+
+	const auto & kernel = options.kernel ? *options.kernel : bestJuliaKernel();
+	const auto periodEpsilon = options.periodicityTolerance * viewport.pixelSpacingX();
+	if (options.precision == Precision::Double)
+	{
+		JuliaRowD row;
+		row.start = {viewport.planeX(x), viewport.planeY(0)};
+		row.first = y;
+		row.column = true;
+		row.step = viewport.pixelSpacingY();
+		row.constant = {viewport.constantRe(), viewport.constantIm()};
+		row.iterations = viewport.iterations;
+		row.periodEpsilon = periodEpsilon;
+		row.count = count;
+		row.out = column.data();
+		kernel.rowDouble(row);
+	}
+	else
+	{
+		JuliaRowF row;
+		row.start = {static_cast<float>(viewport.planeX(x)), static_cast<float>(viewport.planeY(0))};
+		row.first = y;
+		row.column = true;
+		row.step = static_cast<float>(viewport.pixelSpacingY());
+		row.constant = {viewport.constantRe(), viewport.constantIm()};
+		row.iterations = viewport.iterations;
+		row.periodEpsilon = static_cast<float>(periodEpsilon);
+		row.count = count;
+		row.out = column.data();
+		kernel.rowFloat(row);
+	}
+
+	for (auto i = 0; i < count; ++i)
+	{
+		iterations[static_cast<std::size_t>(y + i) * static_cast<std::size_t>(viewport.width) + static_cast<std::size_t>(x)] = column[static_cast<std::size_t>(i)];
+	}
+}
+
+}// namespace fgl
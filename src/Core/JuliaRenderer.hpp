@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Core/JuliaKernel.hpp>
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstdint>
+
+namespace fgl
+{
+
+class TilePool;
+struct DeepViewport;
+
+// Iterations julia() from Shaders/diffuse.fs performs for a single point.
+// Returns a value in [1, iterations], or 0 if iterations is not positive.
+std::uint32_t juliaIterations(float x, float y, float cRe, float cIm, int iterations);
+
+enum class Precision
+{
+	Float,
+	Double,
+	// Double-double and quad-double for views beyond double, without the
+	// reference orbit and glitches of perturbation. They need the centre of
+	// a DeepViewport to gain anything.
+	DoubleDouble,
+	QuadDouble,
+};
+
+struct RenderOptions
+{
+	// Float matches the shader, double goes deeper before pixelating, the
+	// extended ones deeper still at a multiple of the cost.
+	Precision precision = Precision::Float;
+	// Kernel to use, nullptr picks bestJuliaKernel().
+	const JuliaKernel * kernel = nullptr;
+	// Splits the region into square tiles and renders them on the pool.
+	TilePool * pool = nullptr;
+	int tileSize = 64;
+	// Orbits that return within this fraction of a pixel of an earlier point
+	// are cycles and stop as interior right away, 0 iterates every pixel to
+	// the cap like the original shader.
+	double periodicityTolerance = 1e-3;
+	// Whole frame renders compute only one half of the part of the view that
+	// also shows its negation and mirror it, see Core/Symmetry.hpp.
+	bool symmetry = false;
+	// Mariani-Silver subdivision, see Core/Subdivision.hpp.
+	bool subdivide = false;
+};
+
+// Computes iteration counts for the whole viewport into a caller-owned buffer
+// of viewport.width * viewport.height elements, row 0 is the top row.
+void renderJulia(const Viewport & viewport, gsl::span<std::uint32_t> iterations, const RenderOptions & options = {});
+
+// Same as above but only touches the pixels inside the region.
+void renderJulia(const Viewport & viewport, const Rect & region, gsl::span<std::uint32_t> iterations, const RenderOptions & options = {});
+
+// Deep views, view.shiftX and view.shiftY must be 0 as for renderDeep().
+// The extended precisions start from the centre split into 2 or 4 doubles,
+// float and double render the rounded view. Symmetry and subdivision are
+// not supported, the pool splits the view into tiles as above.
+void renderJulia(const DeepViewport & viewport, gsl::span<std::uint32_t> iterations, const RenderOptions & options = {});
+void renderJulia(const DeepViewport & viewport, const Rect & region, gsl::span<std::uint32_t> iterations, const RenderOptions & options = {});
+
+// Computes count pixels of column x from row y down with the column kernels,
+// far cheaper than a one pixel wide region. Points advance in the kernel's
+// precision, so they may differ from a row render in the last bit. Float or
+// double precision only.
+void renderJuliaColumn(const Viewport & viewport, int x, int y, int count, gsl::span<std::uint32_t> iterations,
+					   const RenderOptions & options = {});
+
+}// namespace fgl
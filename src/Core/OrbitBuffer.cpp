@@ -0,0 +1,198 @@
+#include "OrbitBuffer.hpp"
+
+#include "JuliaKernel.hpp"
+#include "JuliaRenderer.hpp"
+#include "Symmetry.hpp"
+#include "TilePool.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <atomic>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_rows_per_task = 16;
+
+template <typename Function>
+void forRows(TilePool * pool, const int height, const Function & function)
+{
+	const auto chunks = (height + g_rows_per_task - 1) / g_rows_per_task;
+	const auto chunk = [&](const std::size_t index) {
+		const auto first = static_cast<int>(index) * g_rows_per_task;
+		function(first, std::min(g_rows_per_task, height - first));
+	};
+	if (pool)
+	{
+		pool->run(static_cast<std::size_t>(chunks), chunk);
+		return;
+	}
+	for (auto i = 0; i < chunks; ++i)
+	{
+		chunk(static_cast<std::size_t>(i));
+	}
+}
+
+}// namespace
+
+void OrbitBuffer::render(const Viewport & viewport, gsl::span<std::uint32_t> iterations, const RenderOptions & options)
+{
+	const auto pixelCount = static_cast<std::size_t>(viewport.width) * static_cast<std::size_t>(viewport.height);
+	Expects(iterations.size() >= pixelCount);
+
+	const auto periodEpsilon = static_cast<float>(options.periodicityTolerance * viewport.pixelSpacingX());
+	const auto seen = hasView_ && sameOrbits(view_, viewport) && periodEpsilon == periodEpsilon_ && options.symmetry == symmetry_;
+	if (!seen)
+	{
+		view_ = viewport;
+		hasView_ = true;
+		valid_ = false;
+		periodEpsilon_ = periodEpsilon;
+		symmetry_ = options.symmetry;
+	}
+
+	// Building the state costs a few times a fresh render and only pays off
+	// once the cap keeps changing, the first cap of new orbits renders from
+	// scratch. The stored orbits went past the bailout of a lower cap
+	// already, that one costs less from scratch than the stored one did.
+	if (!seen || viewport.iterations <= 0 || (valid_ && viewport.iterations < cap_))
+	{
+		auto floatOptions = options;
+		floatOptions.precision = Precision::Float;
+		floatOptions.subdivide = false;
+		renderJulia(viewport, iterations, floatOptions);
+		lastContinued_ = pixelCount;
+		return;
+	}
+	if (!valid_)
+	{
+		reset(viewport);
+	}
+
+	// Only the half symmetry leaves is kept, the other one is mirrored
+	const auto symmetry = options.symmetry ? findSymmetry(viewport) : std::nullopt;
+	const auto regions = symmetry ? symmetricRegions(viewport, *symmetry) : std::vector<Rect>{viewport.bounds()};
+	const auto & kernel = options.kernel ? *options.kernel : bestJuliaKernel();
+	std::atomic<std::size_t> continued{0};
+	const auto cap = viewport.iterations;
+	for (const auto & region : regions)
+	{
+		forRows(options.pool, region.height, [&](const int firstRow, const int rowCount) {
+			if (cap > cap_)
+			{
+				continued += continueRows(kernel, region, firstRow, rowCount, cap);
+			}
+			resolveRows(region, firstRow, rowCount, cap, iterations);
+		});
+	}
+	cap_ = cap;
+	lastContinued_ = continued;
+	if (symmetry)
+	{
+		mirrorBuffer(iterations, viewport.width, *symmetry);
+	}
+}
+
+void OrbitBuffer::clear()
+{
+	hasView_ = false;
+	valid_ = false;
+	x_.clear();
+	y_.clear();
+	savedX_.clear();
+	savedY_.clear();
+	steps_.clear();
+	nextSave_.clear();
+	state_.clear();
+}
+
+void OrbitBuffer::reset(const Viewport & viewport)
+{
+	// The first continueRows() writes the starting points
+	const auto pixelCount = static_cast<std::size_t>(viewport.width) * static_cast<std::size_t>(viewport.height);
+	valid_ = true;
+	cap_ = 0;
+
+	x_.resize(pixelCount);
+	y_.resize(pixelCount);
+	savedX_.resize(pixelCount);
+	savedY_.resize(pixelCount);
+	steps_.resize(pixelCount);
+	nextSave_.resize(pixelCount);
+	state_.resize(pixelCount);
+}
+
+std::size_t OrbitBuffer::continueRows(const JuliaKernel & kernel, const Rect & region, const int firstRow, const int rowCount,
+									  const int cap)
+{
+	const auto bailout = static_cast<float>(cap);
+	// Same starting points as the float row kernels.
+	const auto startX = static_cast<float>(view_.planeX(0));
+	const auto stepX = static_cast<float>(view_.pixelSpacingX());
+
+	std::size_t continued = 0;
+	for (auto row = firstRow; row < firstRow + rowCount; ++row)
+	{
+		const auto y = region.y + row;
+		const auto begin = static_cast<std::size_t>(y) * static_cast<std::size_t>(view_.width) + static_cast<std::size_t>(region.x);
+		const auto end = begin + static_cast<std::size_t>(region.width);
+		if (cap_ == 0)
+		{
+			const auto planeY = static_cast<float>(view_.planeY(y));
+			for (auto i = begin; i < end; ++i)
+			{
+				x_[i] = startX + static_cast<float>(region.x + static_cast<int>(i - begin)) * stepX;
+				y_[i] = planeY;
+				savedX_[i] = x_[i];
+				savedY_[i] = planeY;
+				steps_[i] = 0;
+				nextSave_[i] = 1;
+				state_[i] = orbitIterating;
+			}
+		}
+		else
+		{
+			// Past the old bailout the orbit grows, the new one is a step or
+			// two away
+			std::replace(state_.begin() + static_cast<std::ptrdiff_t>(begin), state_.begin() + static_cast<std::ptrdiff_t>(end),
+						 orbitEscaped, orbitIterating);
+		}
+		continued += static_cast<std::size_t>(std::count(state_.begin() + static_cast<std::ptrdiff_t>(begin),
+														 state_.begin() + static_cast<std::ptrdiff_t>(end), orbitIterating));
+
+		JuliaOrbitsF orbits;
+		orbits.x = x_.data() + begin;
+		orbits.y = y_.data() + begin;
+		orbits.savedX = savedX_.data() + begin;
+		orbits.savedY = savedY_.data() + begin;
+		orbits.steps = steps_.data() + begin;
+		orbits.nextSave = nextSave_.data() + begin;
+		orbits.state = state_.data() + begin;
+		orbits.constant = {view_.constantRe(), view_.constantIm()};
+		orbits.escapeRadiusSquared = bailout * bailout;
+		orbits.iterations = cap;
+		orbits.periodEpsilon = periodEpsilon_;
+		orbits.count = region.width;
+		kernel.orbitsFloat(orbits);
+	}
+	return continued;
+}
+
+void OrbitBuffer::resolveRows(const Rect & region, const int firstRow, const int rowCount, const int cap,
+							  gsl::span<std::uint32_t> iterations) const
+{
+	for (auto row = firstRow; row < firstRow + rowCount; ++row)
+	{
+		const auto begin = static_cast<std::size_t>(region.y + row) * static_cast<std::size_t>(view_.width) + static_cast<std::size_t>(region.x);
+		for (auto i = begin; i < begin + static_cast<std::size_t>(region.width); ++i)
+		{
+			iterations[i] = state_[i] == orbitEscaped ? steps_[i] + 1 : static_cast<std::uint32_t>(cap);
+		}
+	}
+}
+
+}// namespace fgl
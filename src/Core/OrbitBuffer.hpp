@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Core/JuliaRenderer.hpp>
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Per-pixel orbit state (structure of arrays) that survives raising the
+// iteration cap. Every pixel keeps its orbit up to the bailout of the last
+// cap, which is the cap itself, or up to a cycle. Raising the cap continues
+// the pixels still iterating from the old cap and the escaped ones from
+// their last point inside the old bailout. Once |z| > max(2, |c|) the orbit
+// grows monotonically, so those are a step or two from the new bailout.
+// Pixels are advanced by the SIMD orbit kernels with the same periodicity
+// check as the row kernels. Lowering the cap goes back to renderJulia(),
+// which costs less than the stored cap did.
+class OrbitBuffer
+{
+public:
+	// Writes the same counts as renderJulia() with float precision and the
+	// periodicity tolerance and symmetry of the options, the precision and
+	// subdivision are ignored. Anything but the iteration cap changing drops
+	// the state, the state is built on the second cap of the same orbits.
+	void render(const Viewport & viewport, gsl::span<std::uint32_t> iterations, const RenderOptions & options = {});
+
+	// Pixels that had to be iterated beyond the stored state last time.
+	std::size_t lastContinued() const { return lastContinued_; }
+
+	void clear();
+
+private:
+	void reset(const Viewport & viewport);
+	std::size_t continueRows(const JuliaKernel & kernel, const Rect & region, int firstRow, int rowCount, int cap);
+	void resolveRows(const Rect & region, int firstRow, int rowCount, int cap, gsl::span<std::uint32_t> iterations) const;
+
+private:
+	// Orbits of the last call.
+	Viewport view_;
+	bool hasView_ = false;
+	// Whether the state below belongs to view_.
+	bool valid_ = false;
+	// Iterations every pixel still iterating has been advanced to.
+	int cap_ = 0;
+	float periodEpsilon_ = 0.0f;
+	bool symmetry_ = false;
+
+	std::vector<float> x_;
+	std::vector<float> y_;
+	// Point of the periodicity check, see JuliaOrbitsF.
+	std::vector<float> savedX_;
+	std::vector<float> savedY_;
+	// Escaped pixels keep the last point inside the bailout of cap_.
+	std::vector<std::uint32_t> steps_;
+	std::vector<std::uint32_t> nextSave_;
+	// orbitIterating, orbitEscaped or orbitCycled.
+	std::vector<std::uint32_t> state_;
+
+	std::size_t lastContinued_ = 0;
+};
+
+}// namespace fgl
@@ -0,0 +1,72 @@
+#include "Palette.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_pi = 3.14159265358979f;
+
+using Colour = std::array<float, 3>;
+
+Colour cosinePalette(const float t, const Colour & frequency, const Colour & phase)
+{
+	Colour colour{};
+	for (std::size_t i = 0; i < colour.size(); ++i)
+	{
+		colour[i] = 0.5f + 0.5f * std::cos(2.0f * g_pi * (frequency[i] * t + phase[i]));
+	}
+	return colour;
+}
+
+std::uint32_t pack(const Colour & colour)
+{
+	const auto channel = [](const float value) {
+		return static_cast<std::uint32_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+	};
+	return channel(colour[0]) | (channel(colour[1]) << 8u) | (channel(colour[2]) << 16u) | (0xffu << 24u);
+}
+
+}// namespace
+
+void colourise(const Viewport & viewport, gsl::span<const std::uint32_t> iterations, gsl::span<std::uint32_t> rgba,
+			   const ColourSettings & settings)
+{
+	const auto count = static_cast<std::size_t>(viewport.width) * static_cast<std::size_t>(viewport.height);
+	Expects(iterations.size() >= count && rgba.size() >= count);
+
+	const auto cap = static_cast<std::uint32_t>(std::max(viewport.iterations, 0));
+	const auto scale = cap > 0 ? 1.0f / static_cast<float>(cap) : 0.0f;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		auto t = std::pow(std::clamp(static_cast<float>(iterations[i]) * scale, 0.0f, 1.0f), settings.contrast);
+		if (settings.cycle != 0.0f)
+		{
+			t -= std::floor(t + settings.cycle) - settings.cycle;
+		}
+
+		const auto inside = iterations[i] >= cap;
+		switch (settings.palette)
+		{
+			case Palette::Fire:
+				rgba[i] = inside ? pack({0, 0, 0}) : pack(cosinePalette(t, {1.0f, 0.7f, 0.4f}, {0.0f, 0.15f, 0.2f}));
+				break;
+			case Palette::Ocean:
+				rgba[i] = inside ? pack({0, 0, 0}) : pack(cosinePalette(t, {1.0f, 1.0f, 1.0f}, {0.5f, 0.6f, 0.7f}));
+				break;
+			case Palette::Grey:
+			default:
+				rgba[i] = pack({t, t, t});
+				break;
+		}
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstdint>
+
+namespace fgl
+{
+
+// Palettes of Shaders/colourise.fs, values match the palette uniform.
+enum class Palette
+{
+	Grey = 0,
+	Fire = 1,
+	Ocean = 2,
+};
+
+// Colour mapping applied after the iteration counts are known, changing it
+// never requires iterating again.
+struct ColourSettings
+{
+	Palette palette = Palette::Grey;
+	// Exponent applied to the normalised count, 1 keeps it linear.
+	float contrast = 1.0f;
+	// Palette phase in [0, 1), animating it cycles the colours.
+	float cycle = 0.0f;
+};
+
+inline bool operator==(const ColourSettings & lhs, const ColourSettings & rhs)
+{
+	return lhs.palette == rhs.palette && lhs.contrast == rhs.contrast && lhs.cycle == rhs.cycle;
+}
+
+inline bool operator!=(const ColourSettings & lhs, const ColourSettings & rhs) { return !(lhs == rhs); }
+
+// Maps iteration counts to RGBA8 pixels (R in the lowest byte) the same way
+// Shaders/colourise.fs does, without smoothing since counts are integers.
+void colourise(const Viewport & viewport, gsl::span<const std::uint32_t> iterations, gsl::span<std::uint32_t> rgba,
+			   const ColourSettings & settings = {});
+
+}// namespace fgl
@@ -0,0 +1,100 @@
+#include "PanReuse.hpp"
+
+#include <gsl/assert>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Shifts come from float UI state, allow a little rounding noise.
+constexpr auto g_pixel_tolerance = 1e-3;
+
+std::optional<int> wholePixels(const double pixels)
+{
+	const auto rounded = std::round(pixels);
+	if (std::abs(pixels - rounded) > g_pixel_tolerance)
+	{
+		return std::nullopt;
+	}
+	return static_cast<int>(rounded);
+}
+
+}// namespace
+
+std::optional<PixelOffset> panOffset(const Viewport & previous, const Viewport & next)
+{
+	if (!sameFractal(previous, next) || previous.zoom != next.zoom || next.bounds().empty())
+	{
+		return std::nullopt;
+	}
+
+	// planeX() moves by one pixel when the shift changes by 2 / width.
+	const auto dx = wholePixels((next.shiftX - previous.shiftX) * next.width / 2.0);
+	const auto dy = wholePixels(-(next.shiftY - previous.shiftY) * next.height / 2.0);
+	if (!dx || !dy || std::abs(*dx) >= next.width || std::abs(*dy) >= next.height)
+	{
+		return std::nullopt;
+	}
+	return PixelOffset{*dx, *dy};
+}
+
+std::vector<Rect> exposedRegions(const Viewport & viewport, const PixelOffset & offset)
+{
+	std::vector<Rect> regions;
+
+	// Full height column strip on the side the content moved away from.
+	Rect columns{0, 0, std::abs(offset.dx), viewport.height};
+	if (offset.dx > 0)
+	{
+		columns.x = viewport.width - offset.dx;
+	}
+	if (!columns.empty())
+	{
+		regions.push_back(columns);
+	}
+
+	// Row strip without the corner already covered by the columns.
+	Rect rows{offset.dx < 0 ? -offset.dx : 0, 0, viewport.width - std::abs(offset.dx), std::abs(offset.dy)};
+	if (offset.dy > 0)
+	{
+		rows.y = viewport.height - offset.dy;
+	}
+	if (!rows.empty())
+	{
+		regions.push_back(rows);
+	}
+	return regions;
+}
+
+void translateBuffer(gsl::span<std::uint32_t> buffer, const int width, const int height, const PixelOffset & offset)
+{
+	Expects(buffer.size() >= static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+	if (std::abs(offset.dx) >= width || std::abs(offset.dy) >= height)
+	{
+		return;
+	}
+
+	const auto rowLength = static_cast<std::size_t>(width);
+	const auto copyLength = static_cast<std::size_t>(width - std::abs(offset.dx)) * sizeof(std::uint32_t);
+	const auto dstX = offset.dx < 0 ? -offset.dx : 0;
+	const auto srcX = offset.dx > 0 ? offset.dx : 0;
+
+	// Walk rows so sources are read before they are overwritten.
+	const auto firstY = offset.dy > 0 ? 0 : height - 1;
+	const auto lastY = offset.dy > 0 ? height - offset.dy : -offset.dy - 1;
+	const auto stepY = offset.dy > 0 ? 1 : -1;
+	for (auto y = firstY; y != lastY; y += stepY)
+	{
+		auto * dst = buffer.data() + static_cast<std::size_t>(y) * rowLength + dstX;
+		const auto * src = buffer.data() + static_cast<std::size_t>(y + offset.dy) * rowLength + srcX;
+		std::memmove(dst, src, copyLength);
+	}
+}
+
+}// namespace fgl
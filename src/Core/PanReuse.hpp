@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace fgl
+{
+
+// How far the image moved between two frames: pixel (x, y) of the new frame
+// shows what pixel (x + dx, y + dy) of the previous frame showed.
+struct PixelOffset
+{
+	int dx = 0;
+	int dy = 0;
+};
+
+// Returns the offset if next is previous panned by whole pixels and every
+// other parameter is the same, otherwise the frame has to be recomputed.
+std::optional<PixelOffset> panOffset(const Viewport & previous, const Viewport & next);
+
+// Parts of the viewport the previous frame does not cover after the pan,
+// at most one column strip and one row strip.
+std::vector<Rect> exposedRegions(const Viewport & viewport, const PixelOffset & offset);
+
+// Moves the content of a width * height buffer in place by the offset.
+// Exposed pixels keep stale values and have to be rendered afterwards.
+void translateBuffer(gsl::span<std::uint32_t> buffer, int width, int height, const PixelOffset & offset);
+
+}// namespace fgl
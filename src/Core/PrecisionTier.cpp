@@ -0,0 +1,139 @@
+#include "PrecisionTier.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::array<PrecisionTier, 3> g_gpu_tiers = {PrecisionTier::FloatShader, PrecisionTier::Df64Shader,
+													  PrecisionTier::GpuPerturbation};
+constexpr std::array<PrecisionTier, 4> g_cpu_tiers = {PrecisionTier::CpuFloat, PrecisionTier::CpuDouble,
+													  PrecisionTier::CpuDoubleDouble, PrecisionTier::CpuPerturbation};
+
+// Smallest pixel spacing relative to the plane coordinates each tier still
+// resolves, a few bits short of the 24, 48, 53 and 106 bit mantissas.
+// Double-double keeps more margin, it matched perturbation to about 1e26.
+constexpr auto g_float_resolution = 0x1p-20;
+constexpr auto g_df64_resolution = 0x1p-44;
+constexpr auto g_double_resolution = 0x1p-48;
+constexpr auto g_double_double_resolution = 0x1p-90;
+
+// About a dozen wheel steps between switching to a tier and back.
+constexpr auto g_tier_hysteresis = 4.0;
+
+double resolution(const PrecisionTier tier)
+{
+	switch (tier)
+	{
+		case PrecisionTier::FloatShader:
+		case PrecisionTier::CpuFloat:
+			return g_float_resolution;
+		case PrecisionTier::Df64Shader:
+			return g_df64_resolution;
+		case PrecisionTier::CpuDouble:
+			return g_double_resolution;
+		case PrecisionTier::CpuDoubleDouble:
+			return g_double_double_resolution;
+		case PrecisionTier::GpuPerturbation:
+		case PrecisionTier::CpuPerturbation:
+			break;
+	}
+	return 0.0;
+}
+
+bool resolves(const Viewport & view, const PrecisionTier tier, const double margin)
+{
+	// The spacing of an empty view is infinite
+	if (view.width <= 0 || view.height <= 0)
+	{
+		return false;
+	}
+
+	// Relative to the largest coordinate in view, the centre for deep views
+	const auto extent = std::max({1.0, std::abs(view.shiftX / view.zoom), std::abs(view.shiftY / view.zoom)});
+	const auto spacing = std::min(std::abs(view.pixelSpacingX()), std::abs(view.pixelSpacingY()));
+	return spacing >= resolution(tier) * margin * extent;
+}
+
+}// namespace
+
+gsl::span<const PrecisionTier> gpuTiers()
+{
+	return g_gpu_tiers;
+}
+
+gsl::span<const PrecisionTier> cpuTiers()
+{
+	return g_cpu_tiers;
+}
+
+const char * tierName(const PrecisionTier tier)
+{
+	switch (tier)
+	{
+		case PrecisionTier::FloatShader:
+			return "float shader";
+		case PrecisionTier::Df64Shader:
+			return "df64 shader";
+		case PrecisionTier::GpuPerturbation:
+			return "gpu perturbation";
+		case PrecisionTier::CpuFloat:
+			return "cpu float";
+		case PrecisionTier::CpuDouble:
+			return "cpu double";
+		case PrecisionTier::CpuDoubleDouble:
+			return "cpu double-double";
+		case PrecisionTier::CpuPerturbation:
+			return "cpu perturbation";
+	}
+	return "unknown";
+}
+
+bool isPerturbation(const PrecisionTier tier)
+{
+	return tier == PrecisionTier::GpuPerturbation || tier == PrecisionTier::CpuPerturbation;
+}
+
+bool resolves(const Viewport & view, const PrecisionTier tier)
+{
+	return resolves(view, tier, 1.0);
+}
+
+PrecisionPolicy::PrecisionPolicy(const gsl::span<const PrecisionTier> tiers)
+	: tiers_{tiers}
+{
+	Expects(!tiers.empty());
+}
+
+PrecisionTier PrecisionPolicy::update(const Viewport & view)
+{
+	// No tier resolves an empty view, keep the one of the last real one
+	if (view.width <= 0 || view.height <= 0)
+	{
+		return tier();
+	}
+
+	const auto cheapest = std::find_if(tiers_.begin(), tiers_.end(), [&](const auto tier) { return resolves(view, tier); });
+	const auto index = cheapest == tiers_.end() ? static_cast<std::ptrdiff_t>(tiers_.size()) - 1 : cheapest - tiers_.begin();
+	if (index > current_)
+	{
+		current_ = index;
+	}
+	else if (index < current_)
+	{
+		// Cheaper tiers only once they resolve the view with room to spare
+		const auto spare = std::find_if(tiers_.begin(), tiers_.begin() + current_,
+										[&](const auto tier) { return resolves(view, tier, g_tier_hysteresis); });
+		current_ = spare - tiers_.begin();
+	}
+	return tier();
+}
+
+}// namespace fgl
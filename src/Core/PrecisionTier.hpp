@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstddef>
+
+namespace fgl
+{
+
+// Ways of computing the iteration field. Each one tells neighbouring pixels
+// apart down to some pixel spacing relative to the plane coordinates, the
+// perturbation ones at any depth.
+enum class PrecisionTier
+{
+	FloatShader,
+	Df64Shader,
+	GpuPerturbation,
+	CpuFloat,
+	CpuDouble,
+	CpuDoubleDouble,
+	CpuPerturbation,
+};
+
+constexpr std::size_t precisionTierCount = 7;
+
+// The tiers of either backend, cheapest first. Double-double comes before
+// perturbation on the CPU: per pixel it costs more, but it needs no serial
+// reference orbit or glitch correction and its frame time scales with cores.
+gsl::span<const PrecisionTier> gpuTiers();
+gsl::span<const PrecisionTier> cpuTiers();
+
+const char * tierName(PrecisionTier tier);
+
+bool isPerturbation(PrecisionTier tier);
+
+// Whether the tier resolves neighbouring pixels of the view, with a few bits
+// of margin over its mantissa. False for empty views.
+bool resolves(const Viewport & view, PrecisionTier tier);
+
+// Picks the cheapest of a list of tiers that resolves the view. A deeper
+// view moves to a more precise tier as soon as the current one stops
+// resolving it, going back waits until a cheaper one resolves the view with
+// a factor of g_tier_hysteresis to spare. Zooming back and forth across a
+// boundary would otherwise switch tiers, and drop every reused frame, on
+// each step.
+class PrecisionPolicy
+{
+public:
+	// The last tier is used for views none of them resolves, empty views
+	// keep the current one.
+	explicit PrecisionPolicy(gsl::span<const PrecisionTier> tiers);
+
+	PrecisionTier update(const Viewport & view);
+	PrecisionTier tier() const { return tiers_[current_]; }
+
+private:
+	gsl::span<const PrecisionTier> tiers_;
+	std::ptrdiff_t current_ = 0;
+};
+
+}// namespace fgl
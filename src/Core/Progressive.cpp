@@ -0,0 +1,149 @@
+#include "Progressive.hpp"
+
+#include "TilePool.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr int g_coarsest_stride = 8;
+
+// Samples of one row in a pass: x = offset + i * step for every i that
+// falls inside the region.
+struct PassRow
+{
+	int y = 0;
+	int offset = 0;
+	int step = 1;
+};
+
+void renderPassRow(const Viewport & viewport, const Rect & region, const PassRow & pass, gsl::span<std::uint32_t> iterations,
+				   const RenderOptions & options)
+{
+	// First sample at or right of the region edge
+	const auto skip = (pass.offset - region.x % pass.step + pass.step) % pass.step;
+	const auto firstX = region.x + skip;
+	const auto count = (region.x + region.width - firstX + pass.step - 1) / pass.step;
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// Kernels write contiguously, scatter into the row afterwards.
+	thread_local std::vector<std::uint32_t> samples;
+	samples.resize(static_cast<std::size_t>(count));
+
+	// The step is a power of two times the pixel spacing, so points with no
+	// offset land exactly where a full render puts them
+	const auto & kernel = options.kernel ? *options.kernel : bestJuliaKernel();
+	const auto periodEpsilon = options.periodicityTolerance * viewport.pixelSpacingX();
+	const auto first = (firstX - pass.offset) / pass.step;
+	if (options.precision == Precision::Double)
+	{
+		JuliaRowD row;
+		row.start = {viewport.planeX(pass.offset), viewport.planeY(pass.y)};
+		row.first = first;
+		row.step = viewport.pixelSpacingX() * pass.step;
+		row.constant = {viewport.constantRe(), viewport.constantIm()};
+		row.iterations = viewport.iterations;
+		row.periodEpsilon = periodEpsilon;
+		row.count = count;
+		row.out = samples.data();
+		kernel.rowDouble(row);
+	}
+	else
+	{
+		JuliaRowF row;
+		row.start = {static_cast<float>(viewport.planeX(pass.offset)), static_cast<float>(viewport.planeY(pass.y))};
+		row.first = first;
+		row.step = static_cast<float>(viewport.pixelSpacingX()) * static_cast<float>(pass.step);
+		row.constant = {viewport.constantRe(), viewport.constantIm()};
+		row.iterations = viewport.iterations;
+		row.periodEpsilon = static_cast<float>(periodEpsilon);
+		row.count = count;
+		row.out = samples.data();
+		kernel.rowFloat(row);
+	}
+
+	auto * out = iterations.data() + static_cast<std::size_t>(pass.y) * static_cast<std::size_t>(viewport.width);
+	for (auto i = 0; i < count; ++i)
+	{
+		out[firstX + i * pass.step] = samples[static_cast<std::size_t>(i)];
+	}
+}
+
+}// namespace
+
+int progressiveStride(const int pass)
+{
+	Expects(pass >= 0 && pass < progressivePasses);
+	return g_coarsest_stride >> pass;
+}
+
+bool renderProgressivePass(const Viewport & viewport, const Rect & region, const int pass, gsl::span<std::uint32_t> iterations,
+						   const RenderOptions & options, const std::function<bool()> & cancelled)
+{
+	Expects(iterations.size() >= static_cast<std::size_t>(viewport.width) * static_cast<std::size_t>(viewport.height));
+	Expects(region.x >= 0 && region.y >= 0);
+	Expects(region.x + region.width <= viewport.width && region.y + region.height <= viewport.height);
+	Expects(options.precision == Precision::Float || options.precision == Precision::Double);
+
+	// Every row of the stride grid, those on the coarser grid only get the
+	// columns in between
+	const auto stride = progressiveStride(pass);
+	std::vector<PassRow> rows;
+	for (auto y = (region.y + stride - 1) / stride * stride; y < region.y + region.height; y += stride)
+	{
+		const auto coarse = pass > 0 && y % (2 * stride) == 0;
+		rows.push_back(coarse ? PassRow{y, stride, 2 * stride} : PassRow{y, 0, stride});
+	}
+
+	std::atomic<bool> stopped{false};
+	const auto renderRow = [&](const std::size_t index) {
+		if (stopped.load(std::memory_order_relaxed) || (cancelled && cancelled()))
+		{
+			stopped.store(true, std::memory_order_relaxed);
+			return;
+		}
+		renderPassRow(viewport, region, rows[index], iterations, options);
+	};
+	if (options.pool)
+	{
+		options.pool->run(rows.size(), renderRow);
+	}
+	else
+	{
+		for (std::size_t index = 0; index < rows.size(); ++index)
+		{
+			renderRow(index);
+		}
+	}
+	return !stopped.load();
+}
+
+void fillProgressive(gsl::span<const std::uint32_t> samples, const int width, const int height, const int stride,
+					 gsl::span<std::uint32_t> preview)
+{
+	const auto pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+	Expects(stride > 0 && samples.size() >= pixels && preview.size() >= pixels);
+
+	for (auto y = 0; y < height; ++y)
+	{
+		const auto * source = samples.data() + static_cast<std::size_t>(y - y % stride) * static_cast<std::size_t>(width);
+		auto * out = preview.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(width);
+		for (auto x = 0; x < width; ++x)
+		{
+			out[x] = source[x - x % stride];
+		}
+	}
+}
+
+}// namespace fgl
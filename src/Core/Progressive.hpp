@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Core/JuliaRenderer.hpp>
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstdint>
+#include <functional>
+
+namespace fgl
+{
+
+// Progressive refinement computes a frame in passes at 1/8, 1/4, 1/2 and
+// full resolution. As in Adam7 interlacing every pass only computes what no
+// coarser one has: pass p the pixels on the progressiveStride(p) grid that
+// are not on the grid twice as coarse, so the passes together compute each
+// pixel once.
+constexpr int progressivePasses = 4;
+
+// 8, 4, 2 and 1, the samples of a pass sit at multiples of it.
+int progressiveStride(int pass);
+
+// Computes the pixels new in pass inside region, float or double precision
+// without symmetry or subdivision. Rows of the stride grid get the counts
+// of a full render, samples between coarser ones on the same row start from
+// planeX(stride) and may differ in the last bit, like the column kernels.
+// cancelled runs before every row, once it returns true the pass stops and
+// returns false, the rows written so far stay valid.
+bool renderProgressivePass(const Viewport & viewport, const Rect & region, int pass, gsl::span<std::uint32_t> iterations,
+						   const RenderOptions & options = {}, const std::function<bool()> & cancelled = {});
+
+// Copies every sample of the stride grid over the stride x stride block it
+// heads, to show a frame after any pass. Both buffers are width * height.
+void fillProgressive(gsl::span<const std::uint32_t> samples, int width, int height, int stride, gsl::span<std::uint32_t> preview);
+
+}// namespace fgl
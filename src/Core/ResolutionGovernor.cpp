@@ -0,0 +1,74 @@
+#include "ResolutionGovernor.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <cmath>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_scale_steps = 16.0f;
+// Two frames of timer query latency plus the frame that changed the size.
+constexpr auto g_settle_samples = 3;
+// About half a second at the target before the resolution goes up again.
+constexpr auto g_raise_samples = 30;
+// Raised frames should still leave a quarter of the target to spare.
+constexpr auto g_raise_margin = 0.75f;
+
+}// namespace
+
+ResolutionGovernor::ResolutionGovernor(const ResolutionGovernorOptions & options)
+	: options_{options}
+{
+	Expects(options.targetMs > 0.0f);
+	Expects(options.minimumScale > 0.0f && options.minimumScale <= 1.0f);
+}
+
+float ResolutionGovernor::update(const float frameMs)
+{
+	if (settle_ > 0)
+	{
+		--settle_;
+		return scale_;
+	}
+
+	if (frameMs > options_.targetMs)
+	{
+		// Whatever would have fit, rounded down
+		change(scale_ * std::sqrt(options_.targetMs / frameMs));
+		return scale_;
+	}
+
+	slowestMs_ = std::max(slowestMs_, frameMs);
+	if (++fitting_ >= g_raise_samples && scale_ < 1.0f)
+	{
+		const auto fit = scale_ * std::sqrt(options_.targetMs * g_raise_margin / std::max(slowestMs_, 1e-3f));
+		change(std::max(fit, scale_));
+	}
+	return scale_;
+}
+
+void ResolutionGovernor::hold()
+{
+	settle_ = g_settle_samples;
+	slowestMs_ = 0.0f;
+	fitting_ = 0;
+}
+
+void ResolutionGovernor::change(const float scale)
+{
+	const auto stepped = std::clamp(std::floor(scale * g_scale_steps) / g_scale_steps, options_.minimumScale, 1.0f);
+	if (stepped != scale_)
+	{
+		scale_ = stepped;
+		settle_ = g_settle_samples;
+	}
+	slowestMs_ = 0.0f;
+	fitting_ = 0;
+}
+
+}// namespace fgl
@@ -0,0 +1,48 @@
+#pragma once
+
+namespace fgl
+{
+
+struct ResolutionGovernorOptions
+{
+	// Frame time to hold in milliseconds.
+	float targetMs = 16.0f;
+	// Lowest fraction of the native width and height.
+	float minimumScale = 0.25f;
+};
+
+// Picks the fraction of the native width and height a frame is rendered at,
+// so that frames take about targetMs. Frame time is taken to grow with the
+// pixel count, the square of the scale. A frame over the target lowers the
+// scale right away to what would have fit. Raising it waits until
+// g_raise_samples frames in a row would have fit at the higher scale with a
+// margin, so frames that happen to be cheap do not flip the resolution back
+// and forth. Scales are multiples of 1 / g_scale_steps so nearby ones share
+// a size. The first g_settle_samples frames after a change may still have
+// been timed at the old scale, GPU timer queries lag, and are skipped.
+class ResolutionGovernor
+{
+public:
+	explicit ResolutionGovernor(const ResolutionGovernorOptions & options = {});
+
+	// Takes the time of a frame rendered at scale(), returns the scale of the
+	// next one.
+	float update(float frameMs);
+
+	// Skips the next samples, for frames rendered at another scale.
+	void hold();
+
+	float scale() const { return scale_; }
+
+private:
+	void change(float scale);
+
+	ResolutionGovernorOptions options_;
+	float scale_ = 1.0f;
+	int settle_ = 0;
+	// Slowest of the frames in a row that fit the target at scale_.
+	float slowestMs_ = 0.0f;
+	int fitting_ = 0;
+};
+
+}// namespace fgl
@@ -0,0 +1,202 @@
+#include "Subdivision.hpp"
+
+#include "TilePool.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Rectangles with fewer pixels on a side are computed directly, short rows
+// waste most of the SIMD lanes.
+constexpr auto g_min_side = 32;
+// Smaller quarters are not worth a task of their own.
+constexpr auto g_min_spawn_side = 32;
+
+class Subdivider
+{
+public:
+	Subdivider(const Viewport & viewport, gsl::span<std::uint32_t> iterations, const RenderOptions & options)
+		: viewport_{viewport}
+		, iterations_{iterations}
+		, options_{options}
+		, pool_{options.pool}
+	{
+		// Strips are computed directly on the calling worker.
+		options_.pool = nullptr;
+		options_.subdivide = false;
+		options_.symmetry = false;
+	}
+
+	void renderTile(const Rect & tile)
+	{
+		computeBorder(tile);
+		fillOrSplit(tile);
+	}
+
+private:
+	std::uint32_t & at(const int x, const int y)
+	{
+		return iterations_[static_cast<std::size_t>(y) * static_cast<std::size_t>(viewport_.width) + static_cast<std::size_t>(x)];
+	}
+
+	void compute(const Rect & rect)
+	{
+		if (!rect.empty())
+		{
+			renderJulia(viewport_, rect, iterations_, options_);
+		}
+	}
+
+	void computeColumn(const int x, const int y, const int count)
+	{
+		if (count > 0)
+		{
+			renderJuliaColumn(viewport_, x, y, count, iterations_, options_);
+		}
+	}
+
+	void computeBorder(const Rect & rect)
+	{
+		compute({rect.x, rect.y, rect.width, 1});
+		if (rect.height > 1)
+		{
+			compute({rect.x, rect.y + rect.height - 1, rect.width, 1});
+		}
+		computeColumn(rect.x, rect.y + 1, rect.height - 2);
+		if (rect.width > 1)
+		{
+			computeColumn(rect.x + rect.width - 1, rect.y + 1, rect.height - 2);
+		}
+	}
+
+	bool uniformBorder(const Rect & rect, std::uint32_t & value)
+	{
+		value = at(rect.x, rect.y);
+		const auto right = rect.x + rect.width - 1;
+		const auto bottom = rect.y + rect.height - 1;
+		for (auto x = rect.x; x <= right; ++x)
+		{
+			if (at(x, rect.y) != value || at(x, bottom) != value)
+			{
+				return false;
+			}
+		}
+		for (auto y = rect.y + 1; y < bottom; ++y)
+		{
+			if (at(rect.x, y) != value || at(right, y) != value)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// The border of rect is known, only its inside is written.
+	void fillOrSplit(const Rect & rect)
+	{
+		const Rect inside{rect.x + 1, rect.y + 1, rect.width - 2, rect.height - 2};
+		if (inside.empty())
+		{
+			return;
+		}
+
+		std::uint32_t value = 0;
+		if (uniformBorder(rect, value))
+		{
+			for (auto y = inside.y; y < inside.y + inside.height; ++y)
+			{
+				auto * row = &at(inside.x, y);
+				std::fill(row, row + inside.width, value);
+			}
+			return;
+		}
+
+		if (rect.width < g_min_side || rect.height < g_min_side)
+		{
+			compute(inside);
+			return;
+		}
+
+		// Compute the cross, it is the shared border of the four quarters.
+		const auto midX = rect.x + rect.width / 2;
+		const auto midY = rect.y + rect.height / 2;
+		compute({inside.x, midY, inside.width, 1});
+		computeColumn(midX, inside.y, midY - inside.y);
+		computeColumn(midX, midY + 1, inside.y + inside.height - midY - 1);
+
+		const Rect quarters[] = {
+			{rect.x, rect.y, midX - rect.x + 1, midY - rect.y + 1},
+			{midX, rect.y, rect.x + rect.width - midX, midY - rect.y + 1},
+			{rect.x, midY, midX - rect.x + 1, rect.y + rect.height - midY},
+			{midX, midY, rect.x + rect.width - midX, rect.y + rect.height - midY},
+		};
+		for (const auto & quarter : quarters)
+		{
+			// Insides of the quarters do not overlap, so they can run anywhere.
+			if (pool_ && std::min(quarter.width, quarter.height) >= g_min_spawn_side)
+			{
+				pool_->spawn([this, quarter] { fillOrSplit(quarter); });
+			}
+			else
+			{
+				fillOrSplit(quarter);
+			}
+		}
+	}
+
+private:
+	const Viewport & viewport_;
+	gsl::span<std::uint32_t> iterations_;
+	RenderOptions options_;
+	TilePool * pool_;
+};
+
+}// namespace
+
+void renderSubdivided(const Viewport & viewport, const Rect & region, gsl::span<std::uint32_t> iterations,
+					  const RenderOptions & options)
+{
+	Expects(region.x >= 0 && region.y >= 0);
+	Expects(region.x + region.width <= viewport.width && region.y + region.height <= viewport.height);
+	if (region.empty())
+	{
+		return;
+	}
+
+	// Always start from tiles, a single rectangle around the whole view would
+	// have a uniform border whenever the set sits in its middle. Tiles own
+	// disjoint pixels, including their borders.
+	Subdivider subdivider{viewport, iterations, options};
+	const auto tileSize = options.tileSize > 0 ? options.tileSize : RenderOptions{}.tileSize;
+	const auto columns = (region.width + tileSize - 1) / tileSize;
+	const auto rows = (region.height + tileSize - 1) / tileSize;
+	const auto renderTile = [&](const std::size_t index) {
+		const auto column = static_cast<int>(index % static_cast<std::size_t>(columns));
+		const auto row = static_cast<int>(index / static_cast<std::size_t>(columns));
+		Rect tile;
+		tile.x = region.x + column * tileSize;
+		tile.y = region.y + row * tileSize;
+		tile.width = std::min(tileSize, region.x + region.width - tile.x);
+		tile.height = std::min(tileSize, region.y + region.height - tile.y);
+		subdivider.renderTile(tile);
+	};
+
+	const auto tileCount = static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows);
+	if (options.pool)
+	{
+		options.pool->run(tileCount, renderTile);
+		return;
+	}
+	for (std::size_t index = 0; index < tileCount; ++index)
+	{
+		renderTile(index);
+	}
+}
+
+}// namespace fgl
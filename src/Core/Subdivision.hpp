@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Core/JuliaRenderer.hpp>
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstdint>
+
+namespace fgl
+{
+
+// Mariani-Silver rendering: only the border of a rectangle is computed, if
+// every border pixel has the same count the inside is filled with it,
+// otherwise the rectangle is split in four along a computed cross. Relies
+// on the sets being connected, a feature thinner than the rectangle that
+// does not touch its border is missed, so the region is cut into tiles of
+// options.tileSize first. With options.pool set the tiles run on the pool
+// and large splits spawn their quarters as tasks.
+//
+// Only pays off on views dominated by large interior or exterior areas:
+// there it skips most pixels, but on boundary-heavy views, and on views
+// where most pixels escape within a few iterations (the default view), the
+// border passes cost more than they save and it is slower than the direct
+// renderer.
+void renderSubdivided(const Viewport & viewport, const Rect & region, gsl::span<std::uint32_t> iterations,
+					  const RenderOptions & options);
+
+}// namespace fgl
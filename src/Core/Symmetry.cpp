@@ -0,0 +1,99 @@
+#include "Symmetry.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Shifts come from float UI state, allow a little rounding noise.
+constexpr auto g_pixel_tolerance = 1e-3;
+
+std::optional<int> wholePixels(const double pixels)
+{
+	const auto rounded = std::round(pixels);
+	if (std::abs(pixels - rounded) > g_pixel_tolerance)
+	{
+		return std::nullopt;
+	}
+	return static_cast<int>(rounded);
+}
+
+}// namespace
+
+std::optional<Symmetry> findSymmetry(const Viewport & viewport)
+{
+	if (viewport.bounds().empty())
+	{
+		return std::nullopt;
+	}
+
+	// Solving planeX(x') == -planeX(x) gives x + x' == width - 1 - shiftX * width,
+	// and planeY(y') == -planeY(y) gives y + y' == height - 1 + shiftY * height.
+	const auto shiftX = wholePixels(viewport.shiftX * viewport.width);
+	const auto shiftY = wholePixels(viewport.shiftY * viewport.height);
+	if (!shiftX || !shiftY)
+	{
+		return std::nullopt;
+	}
+
+	Symmetry symmetry;
+	symmetry.sumX = viewport.width - 1 - *shiftX;
+	symmetry.sumY = viewport.height - 1 + *shiftY;
+
+	// Pixels whose reflection is inside the viewport as well.
+	const auto left = std::max(0, symmetry.sumX - (viewport.width - 1));
+	const auto right = std::min(viewport.width - 1, symmetry.sumX);
+	const auto top = std::max(0, symmetry.sumY - (viewport.height - 1));
+	const auto bottom = std::min(viewport.height - 1, symmetry.sumY);
+	const auto rows = bottom - top + 1;
+	const auto sourceRows = (rows + 1) / 2;
+	symmetry.source = Rect{left, top, right - left + 1, sourceRows};
+	symmetry.target = Rect{left, top + sourceRows, right - left + 1, rows - sourceRows};
+	if (symmetry.target.empty())
+	{
+		return std::nullopt;
+	}
+	return symmetry;
+}
+
+std::vector<Rect> symmetricRegions(const Viewport & viewport, const Symmetry & symmetry)
+{
+	const auto & target = symmetry.target;
+	const auto targetRight = target.x + target.width;
+	const auto targetBottom = target.y + target.height;
+	const Rect candidates[] = {
+		{0, 0, viewport.width, target.y},
+		{0, target.y, target.x, target.height},
+		{targetRight, target.y, viewport.width - targetRight, target.height},
+		{0, targetBottom, viewport.width, viewport.height - targetBottom},
+	};
+
+	std::vector<Rect> regions;
+	std::copy_if(std::begin(candidates), std::end(candidates), std::back_inserter(regions),
+				 [](const Rect & region) { return !region.empty(); });
+	return regions;
+}
+
+void mirrorBuffer(gsl::span<std::uint32_t> buffer, const int width, const Symmetry & symmetry)
+{
+	const auto & target = symmetry.target;
+	Expects(buffer.size() >= static_cast<std::size_t>(width) * static_cast<std::size_t>(target.y + target.height));
+
+	for (auto y = target.y; y < target.y + target.height; ++y)
+	{
+		auto * row = buffer.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(width);
+		const auto * mirrored = buffer.data() + static_cast<std::size_t>(symmetry.sumY - y) * static_cast<std::size_t>(width);
+		// The reflection also reverses the columns.
+		const auto first = symmetry.sumX - (target.x + target.width - 1);
+		std::reverse_copy(mirrored + first, mirrored + first + target.width, row + target.x);
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Core/Viewport.hpp>
+
+#include <gsl/span>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace fgl
+{
+
+// z -> -z maps the Julia set of z^2 + c onto itself, so a pixel and the one
+// showing the negated point always get the same count. Pixel (x, y) shows
+// the negation of pixel (sumX - x, sumY - y).
+struct Symmetry
+{
+	int sumX = 0;
+	int sumY = 0;
+	// Rows computed directly and rows copied from their reflection, together
+	// they form the part of the viewport that also shows its negation.
+	Rect source;
+	Rect target;
+};
+
+// Returns the symmetry if the origin of the plane falls on the pixel grid
+// (a pixel centre or a pixel edge) and there is something to mirror. Views
+// that are off by a fraction of a pixel have to be computed directly.
+std::optional<Symmetry> findSymmetry(const Viewport & viewport);
+
+// Regions that still have to be computed, everything but the target.
+std::vector<Rect> symmetricRegions(const Viewport & viewport, const Symmetry & symmetry);
+
+// Fills the target of a width wide buffer from the computed source.
+void mirrorBuffer(gsl::span<std::uint32_t> buffer, int width, const Symmetry & symmetry);
+
+}// namespace fgl
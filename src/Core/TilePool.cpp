@@ -0,0 +1,270 @@
+#include "TilePool.hpp"
+
+#include "Trace.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace fgl
+{
+
+namespace
+{
+
+// Pool and worker index of the calling thread, used by spawn().
+thread_local TilePool * currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+void pinToCpu(std::thread & thread, const std::size_t cpu)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % CPU_SETSIZE, &set);
+	pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+	const auto bits = sizeof(DWORD_PTR) * 8;
+	SetThreadAffinityMask(thread.native_handle(), DWORD_PTR{1} << (cpu % bits));
+#else
+	// No portable affinity API, e.g. on macOS.
+	static_cast<void>(thread);
+	static_cast<void>(cpu);
+#endif
+}
+
+std::uint32_t nextRandom(std::uint32_t & state)
+{
+	// xorshift32, only used to pick steal victims.
+	state ^= state << 13u;
+	state ^= state >> 17u;
+	state ^= state << 5u;
+	return state;
+}
+
+}// namespace
+
+TilePool::TilePool(const TilePoolOptions & options)
+{
+	auto threadCount = options.threadCount;
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	workers_.reserve(threadCount);
+	for (unsigned i = 0; i < threadCount; ++i)
+	{
+		workers_.push_back(std::make_unique<Worker>());
+		workers_.back()->random = 0x9e3779b9u * (i + 1);
+	}
+	for (unsigned i = 0; i < threadCount; ++i)
+	{
+		auto & worker = *workers_[i];
+		worker.thread = std::thread{[this, i] { workerLoop(i); }};
+		if (options.pinThreads)
+		{
+			pinToCpu(worker.thread, i);
+		}
+	}
+}
+
+TilePool::~TilePool()
+{
+	stop_ = true;
+	wakeSleepers(true);
+	for (auto & worker : workers_)
+	{
+		worker->thread.join();
+	}
+}
+
+void TilePool::run(const std::size_t count, const std::function<void(std::size_t)> & task)
+{
+	Expects(currentPool != this);
+	if (count == 0)
+	{
+		return;
+	}
+
+	// One frame at a time, concurrent callers would share the pending counter.
+	const std::lock_guard<std::mutex> runLock{runMutex_};
+	const TraceZone zone{"TilePool::run"};
+
+	// Hand out contiguous blocks so neighbouring tiles start on the same
+	// worker, stealing evens out the rest.
+	pending_ += count;
+	const auto workerCount = workers_.size();
+	for (std::size_t w = 0; w < workerCount; ++w)
+	{
+		const auto begin = count * w / workerCount;
+		const auto end = count * (w + 1) / workerCount;
+		for (auto i = begin; i < end; ++i)
+		{
+			push(*workers_[w], [&task, i] { task(i); });
+		}
+	}
+	wakeSleepers(true);
+
+	std::unique_lock<std::mutex> lock{doneMutex_};
+	done_.wait(lock, [this] { return pending_.load() == 0; });
+}
+
+void TilePool::spawn(Task task)
+{
+	Expects(currentPool == this);
+	++pending_;
+	push(*workers_[currentWorker], std::move(task));
+	if (sleepers_.load() > 0)
+	{
+		wakeSleepers(false);
+	}
+}
+
+std::vector<WorkerStats> TilePool::stats() const
+{
+	std::vector<WorkerStats> result;
+	result.reserve(workers_.size());
+	for (const auto & worker : workers_)
+	{
+		WorkerStats stats;
+		stats.executed = worker->executed.load(std::memory_order_relaxed);
+		stats.stolen = worker->stolen.load(std::memory_order_relaxed);
+		stats.failedSteals = worker->failedSteals.load(std::memory_order_relaxed);
+		stats.busySeconds = static_cast<double>(worker->busyNanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+		result.push_back(stats);
+	}
+	return result;
+}
+
+void TilePool::resetStats()
+{
+	for (auto & worker : workers_)
+	{
+		worker->executed = 0;
+		worker->stolen = 0;
+		worker->failedSteals = 0;
+		worker->busyNanoseconds = 0;
+	}
+}
+
+void TilePool::workerLoop(const std::size_t index)
+{
+	currentPool = this;
+	currentWorker = index;
+	setTraceThreadName("tile worker " + std::to_string(index));
+
+	auto & worker = *workers_[index];
+	Task task;
+	while (true)
+	{
+		if (popLocal(worker, task) || steal(index, task))
+		{
+			const auto start = std::chrono::steady_clock::now();
+			{
+				const TraceZone zone{"tile"};
+				task();
+				task = nullptr;
+			}
+			const auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+			worker.busyNanoseconds.fetch_add(static_cast<std::uint64_t>(busy.count()), std::memory_order_relaxed);
+			worker.executed.fetch_add(1, std::memory_order_relaxed);
+
+			if (--pending_ == 0)
+			{
+				const std::lock_guard<std::mutex> lock{doneMutex_};
+				done_.notify_all();
+			}
+			continue;
+		}
+
+		// Nothing to run or steal, sleep until new tasks are queued.
+		std::unique_lock<std::mutex> lock{sleepMutex_};
+		++sleepers_;
+		wake_.wait(lock, [this] { return stop_.load() || queued_.load() > 0; });
+		--sleepers_;
+		if (stop_)
+		{
+			return;
+		}
+	}
+}
+
+bool TilePool::popLocal(Worker & worker, Task & task)
+{
+	const std::lock_guard<std::mutex> lock{worker.mutex};
+	if (worker.tasks.empty())
+	{
+		return false;
+	}
+	task = std::move(worker.tasks.back());
+	worker.tasks.pop_back();
+	--queued_;
+	return true;
+}
+
+bool TilePool::steal(const std::size_t thief, Task & task)
+{
+	auto & self = *workers_[thief];
+	const auto workerCount = workers_.size();
+	const auto first = nextRandom(self.random) % workerCount;
+	for (std::size_t i = 0; i < workerCount; ++i)
+	{
+		const auto victimIndex = (first + i) % workerCount;
+		if (victimIndex == thief || queued_.load(std::memory_order_relaxed) == 0)
+		{
+			continue;
+		}
+
+		auto & victim = *workers_[victimIndex];
+		const std::lock_guard<std::mutex> lock{victim.mutex};
+		if (victim.tasks.empty())
+		{
+			continue;
+		}
+		task = std::move(victim.tasks.front());
+		victim.tasks.pop_front();
+		--queued_;
+		self.stolen.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+	if (queued_.load(std::memory_order_relaxed) > 0)
+	{
+		self.failedSteals.fetch_add(1, std::memory_order_relaxed);
+	}
+	return false;
+}
+
+void TilePool::push(Worker & worker, Task task)
+{
+	{
+		const std::lock_guard<std::mutex> lock{worker.mutex};
+		worker.tasks.push_back(std::move(task));
+	}
+	++queued_;
+}
+
+void TilePool::wakeSleepers(const bool all)
+{
+	const std::lock_guard<std::mutex> lock{sleepMutex_};
+	if (all)
+	{
+		wake_.notify_all();
+	}
+	else
+	{
+		wake_.notify_one();
+	}
+}
+
+}// namespace fgl
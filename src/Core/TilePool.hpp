@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fgl
+{
+
+struct TilePoolOptions
+{
+	// Number of workers, 0 uses std::thread::hardware_concurrency().
+	unsigned threadCount = 0;
+	// Pin worker i to logical CPU i where the platform allows it.
+	bool pinThreads = false;
+};
+
+inline bool operator==(const TilePoolOptions & lhs, const TilePoolOptions & rhs)
+{
+	return lhs.threadCount == rhs.threadCount && lhs.pinThreads == rhs.pinThreads;
+}
+
+inline bool operator!=(const TilePoolOptions & lhs, const TilePoolOptions & rhs) { return !(lhs == rhs); }
+
+struct WorkerStats
+{
+	std::uint64_t executed = 0;
+	// Tasks this worker took from another worker's deque.
+	std::uint64_t stolen = 0;
+	std::uint64_t failedSteals = 0;
+	double busySeconds = 0.0;
+};
+
+// Work-stealing pool with one deque per worker. Owners pop from the back,
+// idle workers steal from the front of a random victim, so uneven tiles
+// (interior vs quickly escaping ones) end up spread over all cores.
+class TilePool
+{
+public:
+	using Task = std::function<void()>;
+
+	explicit TilePool(const TilePoolOptions & options = {});
+	~TilePool();
+
+	TilePool(const TilePool &) = delete;
+	TilePool & operator=(const TilePool &) = delete;
+
+public:
+	unsigned threadCount() const { return static_cast<unsigned>(workers_.size()); }
+
+	// Runs task(i) for every i in [0, count) plus everything they spawn and
+	// blocks until all of it has finished. Tasks must not throw.
+	void run(std::size_t count, const std::function<void(std::size_t)> & task);
+
+	// Queues a task on the calling worker's deque. Only valid from a task.
+	void spawn(Task task);
+
+	std::vector<WorkerStats> stats() const;
+	void resetStats();
+
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		std::thread thread;
+		std::uint32_t random = 0;
+
+		std::atomic<std::uint64_t> executed{0};
+		std::atomic<std::uint64_t> stolen{0};
+		std::atomic<std::uint64_t> failedSteals{0};
+		std::atomic<std::uint64_t> busyNanoseconds{0};
+	};
+
+	void workerLoop(std::size_t index);
+	bool popLocal(Worker & worker, Task & task);
+	bool steal(std::size_t thief, Task & task);
+	void push(Worker & worker, Task task);
+	void wakeSleepers(bool all);
+
+private:
+	std::vector<std::unique_ptr<Worker>> workers_;
+
+	// Tasks sitting in deques and tasks not finished yet.
+	std::atomic<std::size_t> queued_{0};
+	std::atomic<std::size_t> pending_{0};
+	std::atomic<unsigned> sleepers_{0};
+	std::atomic<bool> stop_{false};
+
+	std::mutex sleepMutex_;
+	std::condition_variable wake_;
+	std::mutex doneMutex_;
+	std::condition_variable done_;
+	std::mutex runMutex_;
+};
+
+}// namespace fgl
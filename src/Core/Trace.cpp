@@ -0,0 +1,216 @@
+#include "Trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fgl
+{
+
+namespace
+{
+
+struct TraceEvent
+{
+	const char * name = "";
+	// Chrome phase: 'X' complete zone, 'C' counter, 'i' instant.
+	char phase = 'X';
+	std::int64_t startNs = 0;
+	std::int64_t durationNs = 0;
+	double value = 0.0;
+};
+
+// Events of one thread. Only the owner appends, the lock is uncontended
+// except while stopTrace() collects.
+struct ThreadTrace
+{
+	std::mutex mutex;
+	std::vector<TraceEvent> events;
+	std::string name;
+	int id = 0;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<std::int64_t> g_origin_ns{0};
+
+std::mutex g_threads_mutex;
+std::vector<std::shared_ptr<ThreadTrace>> g_threads;
+
+std::int64_t nowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ThreadTrace & threadTrace()
+{
+	// Shared with the registry so events survive the thread.
+	thread_local std::shared_ptr<ThreadTrace> trace = [] {
+		auto created = std::make_shared<ThreadTrace>();
+		const std::lock_guard<std::mutex> lock{g_threads_mutex};
+		created->id = static_cast<int>(g_threads.size()) + 1;
+		created->events.reserve(4096);
+		g_threads.push_back(created);
+		return created;
+	}();
+	return *trace;
+}
+
+void append(const TraceEvent & event)
+{
+	auto & trace = threadTrace();
+	const std::lock_guard<std::mutex> lock{trace.mutex};
+	trace.events.push_back(event);
+}
+
+void writeString(std::FILE * file, const char * text)
+{
+	std::fputc('"', file);
+	for (auto * c = text; *c != '\0'; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			std::fputc('\\', file);
+		}
+		std::fputc(*c, file);
+	}
+	std::fputc('"', file);
+}
+
+}// namespace
+
+void startTrace()
+{
+	g_enabled = false;
+	{
+		const std::lock_guard<std::mutex> lock{g_threads_mutex};
+		for (auto & thread : g_threads)
+		{
+			const std::lock_guard<std::mutex> threadLock{thread->mutex};
+			thread->events.clear();
+		}
+	}
+	g_origin_ns = nowNs();
+	g_enabled = true;
+}
+
+bool stopTrace(const std::string & path)
+{
+	if (!g_enabled.exchange(false))
+	{
+		return false;
+	}
+
+	auto * file = std::fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	auto first = true;
+	const auto separator = [&first, file] {
+		std::fprintf(file, first ? "" : ",\n");
+		first = false;
+	};
+
+	const std::lock_guard<std::mutex> lock{g_threads_mutex};
+	const auto origin = g_origin_ns.load();
+	for (auto & thread : g_threads)
+	{
+		const std::lock_guard<std::mutex> threadLock{thread->mutex};
+		if (!thread->name.empty())
+		{
+			separator();
+			std::fprintf(file, "{\"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"name\": \"thread_name\", \"args\": {\"name\": ", thread->id);
+			writeString(file, thread->name.c_str());
+			std::fprintf(file, "}}");
+		}
+		for (const auto & event : thread->events)
+		{
+			// Timestamps are in microseconds.
+			const auto ts = static_cast<double>(event.startNs - origin) * 1e-3;
+			separator();
+			std::fprintf(file, "{\"ph\": \"%c\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"name\": ", event.phase, thread->id, ts);
+			writeString(file, event.name);
+			switch (event.phase)
+			{
+				case 'X':
+					std::fprintf(file, ", \"dur\": %.3f}", static_cast<double>(event.durationNs) * 1e-3);
+					break;
+				case 'C':
+					std::fprintf(file, ", \"args\": {\"value\": %.6g}}", event.value);
+					break;
+				default:
+					std::fprintf(file, ", \"s\": \"t\"}");
+					break;
+			}
+		}
+		thread->events.clear();
+	}
+	std::fprintf(file, "\n]}\n");
+	return std::fclose(file) == 0;
+}
+
+bool isTracing() { return g_enabled.load(std::memory_order_relaxed); }
+
+void setTraceThreadName(const std::string & name)
+{
+	auto & trace = threadTrace();
+	const std::lock_guard<std::mutex> lock{trace.mutex};
+	trace.name = name;
+}
+
+void traceCounter(const char * name, const double value)
+{
+	if (!isTracing())
+	{
+		return;
+	}
+	TraceEvent event;
+	event.name = name;
+	event.phase = 'C';
+	event.startNs = nowNs();
+	event.value = value;
+	append(event);
+}
+
+void traceInstant(const char * name)
+{
+	if (!isTracing())
+	{
+		return;
+	}
+	TraceEvent event;
+	event.name = name;
+	event.phase = 'i';
+	event.startNs = nowNs();
+	append(event);
+}
+
+TraceZone::TraceZone(const char * name)
+	: name_{name}
+{
+	if (isTracing())
+	{
+		start_ = nowNs();
+	}
+}
+
+TraceZone::~TraceZone()
+{
+	// Zones that started before the trace are dropped.
+	if (start_ < 0 || !isTracing())
+	{
+		return;
+	}
+	TraceEvent event;
+	event.name = name_;
+	event.startNs = start_;
+	event.durationNs = nowNs() - start_;
+	append(event);
+}
+
+}// namespace fgl
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace fgl
+{
+
+// Built-in tracing that writes Chrome trace-event JSON, loadable in
+// chrome://tracing or Perfetto. While no trace is running every call below
+// costs one relaxed atomic load. Event names must be string literals or
+// otherwise outlive the trace, only the pointer is stored.
+
+// Starts a new trace, dropping events of a previous one.
+void startTrace();
+
+// Stops the running trace and writes it to path. Returns false if no trace
+// was running or the file could not be written.
+bool stopTrace(const std::string & path);
+
+bool isTracing();
+
+// Names the calling thread in the trace viewer.
+void setTraceThreadName(const std::string & name);
+
+// Value of a counter track at the current time.
+void traceCounter(const char * name, double value);
+
+// Zero-length marker on the calling thread.
+void traceInstant(const char * name);
+
+// Records the time between construction and destruction as one zone of the
+// calling thread.
+class TraceZone
+{
+public:
+	explicit TraceZone(const char * name);
+	~TraceZone();
+
+	TraceZone(const TraceZone &) = delete;
+	TraceZone & operator=(const TraceZone &) = delete;
+
+private:
+	const char * name_;
+	std::int64_t start_ = -1;
+};
+
+}// namespace fgl
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace fgl
+{
+
+// Lock-free single producer, single consumer triple buffer. The producer
+// never waits for the consumer and the consumer always sees the newest
+// complete value, intermediate values may be skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() = default;
+	explicit TripleBuffer(const T & initial)
+		: buffers_{initial, initial, initial}
+	{
+	}
+
+public:
+	// Producer side.
+	void publish(const T & value)
+	{
+		buffers_[back_] = value;
+		const auto previous = middle_.exchange(static_cast<std::uint8_t>(back_ | freshBit), std::memory_order_acq_rel);
+		back_ = previous & indexMask;
+	}
+
+	// Consumer side, swaps in the newest value. Returns false if nothing new
+	// was published since the last call.
+	bool update()
+	{
+		if ((middle_.load(std::memory_order_relaxed) & freshBit) == 0)
+		{
+			return false;
+		}
+		const auto previous = middle_.exchange(static_cast<std::uint8_t>(front_), std::memory_order_acq_rel);
+		front_ = previous & indexMask;
+		return true;
+	}
+
+	// Consumer side, value swapped in by the last update().
+	const T & latest() const { return buffers_[front_]; }
+
+	// Consumer side, true if update() would return a new value.
+	bool hasUpdate() const { return (middle_.load(std::memory_order_acquire) & freshBit) != 0; }
+
+private:
+	static constexpr std::uint8_t indexMask = 0x3u;
+	static constexpr std::uint8_t freshBit = 0x4u;
+
+	std::array<T, 3> buffers_{};
+	std::uint8_t back_ = 0;
+	std::atomic<std::uint8_t> middle_{1};
+	std::uint8_t front_ = 2;
+};
+
+}// namespace fgl
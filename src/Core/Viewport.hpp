@@ -0,0 +1,79 @@
+#pragma once
+
+namespace fgl
+{
+
+// Pixel rectangle inside a viewport, rows go from top to bottom.
+struct Rect
+{
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+
+	bool empty() const { return width <= 0 || height <= 0; }
+};
+
+// Everything needed to compute one frame of the Julia set.
+// Mirrors the uniforms of Shaders/diffuse.vs and Shaders/diffuse.fs.
+struct Viewport
+{
+	int width = 0;
+	int height = 0;
+
+	double zoom = 0.4;
+	double shiftX = 0.0;
+	double shiftY = 0.0;
+
+	float param1 = 2.0f;
+	float param2 = -0.345f;
+	float param3 = 0.654f;
+
+	int iterations = 100;
+
+	Rect bounds() const { return Rect{0, 0, width, height}; }
+
+	// Plane coordinates of the pixel centre, (vert_offset + shift) / zoom in
+	// the shader.
+	double planeX(const int x) const { return ((2.0 * x + 1.0) / width - 1.0 + shiftX) / zoom; }
+	double planeY(const int y) const { return (1.0 - (2.0 * y + 1.0) / height + shiftY) / zoom; }
+
+	// Distance between two neighbouring pixel centres on the plane.
+	double pixelSpacingX() const { return 2.0 / (width * zoom); }
+	double pixelSpacingY() const { return -2.0 / (height * zoom); }
+
+	// Julia constant c + d from julia() in the shader.
+	float constantRe() const { return param2 * 0.001f + param1 * 0.001f * 0.005f; }
+	float constantIm() const { return param3 * 0.001f; }
+
+	// The shader escapes once length(uv) > float(iterations).
+	float bailout() const { return static_cast<float>(iterations); }
+};
+
+inline bool operator==(const Viewport & lhs, const Viewport & rhs)
+{
+	return lhs.width == rhs.width && lhs.height == rhs.height
+		&& lhs.zoom == rhs.zoom && lhs.shiftX == rhs.shiftX && lhs.shiftY == rhs.shiftY
+		&& lhs.param1 == rhs.param1 && lhs.param2 == rhs.param2 && lhs.param3 == rhs.param3
+		&& lhs.iterations == rhs.iterations;
+}
+
+inline bool operator!=(const Viewport & lhs, const Viewport & rhs) { return !(lhs == rhs); }
+
+// Same image size and fractal, possibly looked at from another position.
+inline bool sameFractal(const Viewport & lhs, const Viewport & rhs)
+{
+	return lhs.width == rhs.width && lhs.height == rhs.height
+		&& lhs.param1 == rhs.param1 && lhs.param2 == rhs.param2 && lhs.param3 == rhs.param3
+		&& lhs.iterations == rhs.iterations;
+}
+
+// Same starting points and constant, only the iteration cap may differ.
+inline bool sameOrbits(const Viewport & lhs, const Viewport & rhs)
+{
+	auto capped = rhs;
+	capped.iterations = lhs.iterations;
+	return lhs == capped;
+}
+
+}// namespace fgl